@@ -0,0 +1,241 @@
+/**
+ * @file avi_writer.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the AviWriter class, which muxes
+ *        pre-encoded JPEG frames into a Motion-JPEG AVI file.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "../include/avi_writer.hpp"
+
+namespace {
+
+// File offsets of the header fields patched when the file is closed.
+const long kRiffSizeOffset = 4;            ///< Size of the RIFF chunk
+const long kMicroSecPerFrameOffset = 32;   ///< avih.dwMicroSecPerFrame
+const long kTotalFramesOffset = 48;        ///< avih.dwTotalFrames
+const long kAvihBufferSizeOffset = 60;     ///< avih.dwSuggestedBufferSize
+const long kScaleOffset = 128;             ///< strh.dwScale
+const long kRateOffset = 132;              ///< strh.dwRate
+const long kLengthOffset = 140;            ///< strh.dwLength
+const long kStrhBufferSizeOffset = 144;    ///< strh.dwSuggestedBufferSize
+const long kMoviSizeOffset = 216;          ///< Size of the movi list
+
+const uint32_t kAvifHasIndex = 0x10;       ///< avih flag: the file has an idx1 index
+const uint32_t kAviifKeyframe = 0x10;      ///< idx1 flag: the chunk is a key frame
+
+}  // namespace
+
+/**
+ * @brief Constructs a closed AviWriter.
+ */
+TrackAI::AviWriter::AviWriter()
+    : file(nullptr), width(0), height(0), frames(0), max_frame_bytes(0),
+      movi_offset(0) {}
+
+/**
+ * @brief Finalizes the file if it is still open.
+ */
+TrackAI::AviWriter::~AviWriter() {
+    if (file) {
+        Close(5.0);
+    }
+}
+
+void TrackAI::AviWriter::Put32(uint32_t value) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8),
+        static_cast<unsigned char>(value >> 16),
+        static_cast<unsigned char>(value >> 24)};
+    std::fwrite(bytes, 1, 4, file);
+}
+
+void TrackAI::AviWriter::Put16(uint16_t value) {
+    unsigned char bytes[2] = {static_cast<unsigned char>(value),
+                              static_cast<unsigned char>(value >> 8)};
+    std::fwrite(bytes, 1, 2, file);
+}
+
+void TrackAI::AviWriter::PutFourcc(const char *fourcc) {
+    std::fwrite(fourcc, 1, 4, file);
+}
+
+void TrackAI::AviWriter::Patch32(long offset, uint32_t value) {
+    std::fseek(file, offset, SEEK_SET);
+    Put32(value);
+}
+
+/**
+ * @brief Creates the file and writes the headers.
+ *
+ * The headers are written with placeholder sizes, counts and rates that
+ * Close fills in.
+ *
+ * @param path The path of the AVI file.
+ * @param frame_width The width of every frame.
+ * @param frame_height The height of every frame.
+ * @return False if the file could not be created.
+ */
+bool TrackAI::AviWriter::Open(const std::string &path, int frame_width,
+    int frame_height) {
+    if (file) {
+        Close(5.0);
+    }
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    width = frame_width;
+    height = frame_height;
+    frames = 0;
+    max_frame_bytes = 0;
+    index.clear();
+
+    PutFourcc("RIFF");
+    Put32(0);                        // RIFF size, patched on close
+    PutFourcc("AVI ");
+
+    PutFourcc("LIST");
+    Put32(192);                      // hdrl size: 4 + (8 + 56) + (8 + 116)
+    PutFourcc("hdrl");
+
+    PutFourcc("avih");
+    Put32(56);
+    Put32(0);                        // dwMicroSecPerFrame, patched on close
+    Put32(0);                        // dwMaxBytesPerSec
+    Put32(0);                        // dwPaddingGranularity
+    Put32(kAvifHasIndex);            // dwFlags
+    Put32(0);                        // dwTotalFrames, patched on close
+    Put32(0);                        // dwInitialFrames
+    Put32(1);                        // dwStreams
+    Put32(0);                        // dwSuggestedBufferSize, patched on close
+    Put32(width);                    // dwWidth
+    Put32(height);                   // dwHeight
+    for (int i = 0; i < 4; ++i) {
+        Put32(0);                    // dwReserved
+    }
+
+    PutFourcc("LIST");
+    Put32(116);                      // strl size: 4 + (8 + 56) + (8 + 40)
+    PutFourcc("strl");
+
+    PutFourcc("strh");
+    Put32(56);
+    PutFourcc("vids");               // fccType
+    PutFourcc("MJPG");               // fccHandler
+    Put32(0);                        // dwFlags
+    Put16(0);                        // wPriority
+    Put16(0);                        // wLanguage
+    Put32(0);                        // dwInitialFrames
+    Put32(1);                        // dwScale, patched on close
+    Put32(0);                        // dwRate, patched on close
+    Put32(0);                        // dwStart
+    Put32(0);                        // dwLength, patched on close
+    Put32(0);                        // dwSuggestedBufferSize, patched on close
+    Put32(0xFFFFFFFF);               // dwQuality (default)
+    Put32(0);                        // dwSampleSize
+    Put16(0);                        // rcFrame.left
+    Put16(0);                        // rcFrame.top
+    Put16(static_cast<uint16_t>(width));    // rcFrame.right
+    Put16(static_cast<uint16_t>(height));   // rcFrame.bottom
+
+    PutFourcc("strf");
+    Put32(40);
+    Put32(40);                       // biSize
+    Put32(width);                    // biWidth
+    Put32(height);                   // biHeight
+    Put16(1);                        // biPlanes
+    Put16(24);                       // biBitCount
+    PutFourcc("MJPG");               // biCompression
+    Put32(width * height * 3);       // biSizeImage
+    for (int i = 0; i < 4; ++i) {
+        Put32(0);                    // Resolution and palette fields
+    }
+
+    PutFourcc("LIST");
+    Put32(0);                        // movi size, patched on close
+    movi_offset = std::ftell(file);
+    PutFourcc("movi");
+
+    return !std::ferror(file);
+}
+
+/**
+ * @brief Appends one JPEG-encoded frame.
+ *
+ * @param jpeg The encoded frame.
+ * @return False if the write failed.
+ */
+bool TrackAI::AviWriter::WriteFrame(const std::vector<unsigned char> &jpeg) {
+    if (!file) return false;
+
+    const uint32_t size = static_cast<uint32_t>(jpeg.size());
+    index.push_back(static_cast<uint32_t>(std::ftell(file) - movi_offset));
+    index.push_back(size);
+
+    PutFourcc("00dc");
+    Put32(size);
+    std::fwrite(jpeg.data(), 1, jpeg.size(), file);
+    if (size % 2) {
+        std::fputc(0, file);         // Chunks are padded to an even size
+    }
+
+    frames++;
+    max_frame_bytes = std::max(max_frame_bytes, size);
+    return !std::ferror(file);
+}
+
+/**
+ * @brief Writes the index, patches the headers and closes the file.
+ *
+ * @param fps The frame rate stored in the headers.
+ */
+void TrackAI::AviWriter::Close(double fps) {
+    if (!file) return;
+    if (!(fps > 0.0)) fps = 5.0;
+
+    const long movi_end = std::ftell(file);
+    PutFourcc("idx1");
+    Put32(static_cast<uint32_t>(index.size() * 8));
+    for (size_t i = 0; i < index.size(); i += 2) {
+        PutFourcc("00dc");
+        Put32(kAviifKeyframe);
+        Put32(index[i]);
+        Put32(index[i + 1]);
+    }
+    const long file_end = std::ftell(file);
+
+    const uint32_t scale = 1000;
+    const uint32_t rate = static_cast<uint32_t>(std::lround(fps * scale));
+    Patch32(kRiffSizeOffset, static_cast<uint32_t>(file_end - 8));
+    Patch32(kMicroSecPerFrameOffset,
+            static_cast<uint32_t>(std::lround(1e6 / fps)));
+    Patch32(kTotalFramesOffset, frames);
+    Patch32(kAvihBufferSizeOffset, max_frame_bytes + 8);
+    Patch32(kScaleOffset, scale);
+    Patch32(kRateOffset, rate);
+    Patch32(kLengthOffset, frames);
+    Patch32(kStrhBufferSizeOffset, max_frame_bytes + 8);
+    Patch32(kMoviSizeOffset, static_cast<uint32_t>(movi_end - movi_offset));
+
+    std::fclose(file);
+    file = nullptr;
+}
+
+/**
+ * @brief Returns whether a file is open.
+ */
+bool TrackAI::AviWriter::IsOpen() const {
+    return file != nullptr;
+}
+
+/**
+ * @brief Returns the number of frames written to the current file.
+ */
+uint32_t TrackAI::AviWriter::Frames() const {
+    return frames;
+}
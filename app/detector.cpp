@@ -12,7 +12,9 @@
  */
 
 #include <opencv2/core/hal/interface.h>
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <opencv2/core.hpp>
 #include <opencv2/dnn/dnn.hpp>
 #include <opencv2/highgui.hpp>
@@ -23,39 +25,265 @@
 #include <../include/robot.hpp>
 #include <../include/visualizer.hpp>
 
+namespace {
+
+    /**
+    * @brief Names of the 80 COCO classes, in the order of the YOLO outputs.
+    */
+    const char *const kCocoClasses[] = {
+        "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train",
+        "truck", "boat", "traffic light", "fire hydrant", "stop sign",
+        "parking meter", "bench", "bird", "cat", "dog", "horse", "sheep", "cow",
+        "elephant", "bear", "zebra", "giraffe", "backpack", "umbrella",
+        "handbag", "tie", "suitcase", "frisbee", "skis", "snowboard",
+        "sports ball", "kite", "baseball bat", "baseball glove", "skateboard",
+        "surfboard", "tennis racket", "bottle", "wine glass", "cup", "fork",
+        "knife", "spoon", "bowl", "banana", "apple", "sandwich", "orange",
+        "broccoli", "carrot", "hot dog", "pizza", "donut", "cake", "chair",
+        "couch", "potted plant", "bed", "dining table", "toilet", "tv",
+        "laptop", "mouse", "remote", "keyboard", "cell phone", "microwave",
+        "oven", "toaster", "sink", "refrigerator", "book", "clock", "vase",
+        "scissors", "teddy bear", "hair drier", "toothbrush"};
+
+}  // namespace
+
 /**
  * @brief Default constructor for the Detector class.
  *
  * Initializes the input dimensions and threshold values for the model.
  */
-TrackAI::Detector::Detector() {
+TrackAI::Detector::Detector()
+    : inference_ms(0.0),
+      person_only(true),
+      output_format{OutputLayout::YOLOV8, 0, 0},
+      decode(nullptr),
+      region_format{OutputLayout::YOLOV8, 0, 0},
+      region_decode(nullptr) {
     input_height = 640.0;    ///< Height of the input image
     input_width = 640.0;     ///< Width of the input image
     SCORE_THRESHOLD = 0.45;   ///< Score threshold for filtering detections
     NMS_THRESHOLD = 0.50;     ///< Non-Maximum Suppression threshold
+    class_list.push_back("person");  // Known before a model is loaded
+
+    stopping = false;
+    next_ticket = 0;
+    stats = AsyncStats{0, 0, 0, 0, 0.0, 0.0};
+    for (InferenceSlot &slot : slots) {
+        slot.state = InferenceSlot::FREE;
+        slot.ticket = 0;
+        slot.submit_tick = 0;
+    }
+}
+
+/**
+ * @brief Destructor for the Detector class.
+ *
+ * Stops and joins the inference thread if it was started.
+ */
+TrackAI::Detector::~Detector() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
 }
 
 /**
  * @brief Loads the deep learning model for detection.
  *
  * This method loads the model from the specified path and initializes the 
- * DNN network for inference.
+ * DNN network for inference, see Prepare.
  *
  * @param model_path A reference to a string containing the path to the 
  *                   model file.
+ * @param person_only Whether only the person class is decoded.
+ * @param prune_head Whether the output is sliced to the person channels.
  * @return The loaded DNN network.
  * @throws std::runtime_error If the model fails to load.
  */
-cv::dnn::Net TrackAI::Detector::Load(std::string &model_path) {
-    class_list.clear();
-    class_list.push_back("person");
+cv::dnn::Net TrackAI::Detector::Load(std::string &model_path,
+    bool person_only, bool prune_head) {
     net = cv::dnn::readNetFromONNX(model_path);  // Load model from ONNX format
     if (net.empty()) {
         throw std::runtime_error("Failed to load model: " + model_path);
     }
+    Prepare(person_only, prune_head, nullptr);
+    return net;
+}
+
+/**
+ * @brief Loads the deep learning model from an ONNX file held in memory.
+ *
+ * When another detector loaded from the same model is given, the layers
+ * take their weight blobs from it; see ShareWeights for what that saves.
+ *
+ * @param model_data The content of the ONNX model file.
+ * @param person_only Whether only the person class is decoded.
+ * @param prune_head Whether the output is sliced to the person channels.
+ * @param weights A detector already loaded from the same model, or nullptr.
+ * @return The loaded DNN network.
+ * @throws std::runtime_error If the model fails to load.
+ */
+cv::dnn::Net TrackAI::Detector::Load(const std::vector<uchar> &model_data,
+    bool person_only, bool prune_head, const Detector *weights) {
+    net = cv::dnn::readNetFromONNX(model_data);
+    if (net.empty()) {
+        throw std::runtime_error("Failed to load model from memory");
+    }
+    Prepare(person_only, prune_head, weights);
+    return net;
+}
+
+/**
+ * @brief Configures a freshly read network and selects its decoder.
+ *
+ * The weights are shared before the first forward pass, while no layer has
+ * derived its own buffers from them yet. A warm-up pass on a blank input
+ * then reveals the output shape, from which the decoder is selected.
+ *
+ * @param person_only Whether only the person class is decoded.
+ * @param prune_head Whether the output is sliced to the person channels.
+ * @param weights A detector already loaded from the same model, or nullptr.
+ */
+void TrackAI::Detector::Prepare(bool person_only, bool prune_head,
+    const Detector *weights) {
+    this->person_only = person_only;
+    decode = nullptr;
+    region_decode = nullptr;
+    if (weights) {
+        ShareWeights(weights->net);
+    }
     net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
     net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-    return net;
+    output_names = net.getUnconnectedOutLayersNames();
+    if (person_only && prune_head) {
+        PruneToPerson();
+    }
+
+    // Warm-up pass on a blank input to learn the output shape of the model.
+    const int input_shape[] = {1, 3, static_cast<int>(input_height),
+                               static_cast<int>(input_width)};
+    cv::Mat blank(4, input_shape, CV_32F, cv::Scalar(0));
+    std::vector<cv::Mat> outputs;
+    net.setInput(blank);
+    net.forward(outputs, output_names);
+    SelectDecoderFor(outputs[0]);
+}
+
+/**
+ * @brief Replaces the weights of every layer by those of another network.
+ *
+ * The blobs are reference-counted, so assigning them makes the layers of
+ * both networks point at the same matrices. This does not prove that the
+ * copy parsed by this network is freed: OpenCV may keep referencing it from
+ * the layer parameters, and some layers pack their own copy of the weights
+ * when the network is set up. DetectorService measures what a replica
+ * really costs. Layers are matched by name, and only blobs of identical
+ * shape are shared.
+ *
+ * @param source A network read from the same model.
+ */
+void TrackAI::Detector::ShareWeights(cv::dnn::Net source) {
+    for (const std::string &name : net.getLayerNames()) {
+        const int source_id = source.getLayerId(name);
+        if (source_id < 0) continue;
+
+        cv::Ptr<cv::dnn::Layer> from = source.getLayer(source_id);
+        cv::Ptr<cv::dnn::Layer> to = net.getLayer(net.getLayerId(name));
+        if (from->blobs.size() != to->blobs.size()) continue;
+
+        bool same_shape = true;
+        for (size_t b = 0; b < from->blobs.size(); ++b) {
+            same_shape = same_shape &&
+                from->blobs[b].type() == to->blobs[b].type() &&
+                from->blobs[b].size == to->blobs[b].size;
+        }
+        if (same_shape) {
+            to->blobs = from->blobs;
+        }
+    }
+}
+
+/**
+ * @brief Appends a slice layer keeping only the person channels of the output.
+ *
+ * The output shape is inferred without running the network. For the YOLOv8
+ * layout the 4 box rows and the person score row are kept, shrinking the
+ * 1 x 84 x 8400 output to 1 x 5 x 8400; for the YOLOv5 layout the box,
+ * objectness and person score of every anchor are kept. The class scores
+ * are still computed by the head, but are no longer copied out of the
+ * network, collected or decoded. Single-class models are left unchanged.
+ *
+ * @throws std::runtime_error If the output shape is not a supported YOLO output.
+ */
+void TrackAI::Detector::PruneToPerson() {
+    cv::dnn::MatShape input_shape = {1, 3, static_cast<int>(input_height),
+                                     static_cast<int>(input_width)};
+    const int output_id = net.getLayerId(output_names[0]);
+    std::vector<cv::dnn::MatShape> in_shapes;
+    std::vector<cv::dnn::MatShape> out_shapes;
+    net.getLayerShapes(input_shape, output_id, in_shapes, out_shapes);
+
+    OutputFormat format;
+    if (out_shapes.empty() ||
+        !DescribeOutput(cv::Mat(out_shapes[0], CV_32F), &format)) {
+        throw std::runtime_error("Unsupported model output shape");
+    }
+    if (format.classes == 1) return;  // Nothing to prune
+
+    const int begin[] = {0, 0, 0};
+    const int yolov8_size[] = {-1, 5, -1};   // Box rows and the person row
+    const int yolov5_size[] = {-1, -1, 6};   // Box, objectness and person score
+    cv::dnn::LayerParams params;
+    params.name = "person_head";
+    params.type = "Slice";
+    params.set("begin", cv::dnn::DictValue::arrayInt(begin, 3));
+    params.set("size", cv::dnn::DictValue::arrayInt(
+        format.layout == OutputLayout::YOLOV8 ? yolov8_size : yolov5_size, 3));
+
+    const int slice_id = net.addLayer(params.name, params.type, params);
+    net.connect(output_id, 0, slice_id, 0);
+    output_names = net.getUnconnectedOutLayersNames();
+}
+
+/**
+ * @brief Returns the output format the decoder was selected for.
+ */
+TrackAI::OutputFormat TrackAI::Detector::Format() const {
+    return output_format;
+}
+
+/**
+ * @brief Selects the decoder for the shape of a model output.
+ *
+ * The class list is rebuilt to match: only "person" for person-only
+ * decoding, the COCO names for an 80-class model, and numbered names for
+ * any other class count.
+ *
+ * @param output The first output tensor of the model.
+ * @throws std::runtime_error If the shape is not a supported YOLO output.
+ */
+void TrackAI::Detector::SelectDecoderFor(const cv::Mat &output) {
+    OutputFormat format;
+    if (!DescribeOutput(output, &format)) {
+        throw std::runtime_error("Unsupported model output shape");
+    }
+    output_format = format;
+    decode = SelectDecoder(format, person_only);
+
+    class_list.clear();
+    if (person_only) {
+        class_list.push_back("person");
+    } else if (format.classes == 80) {
+        class_list.assign(std::begin(kCocoClasses), std::end(kCocoClasses));
+    } else {
+        for (int c = 0; c < format.classes; ++c) {
+            class_list.push_back("class " + std::to_string(c));
+        }
+    }
 }
 
 /**
@@ -85,11 +313,228 @@ std::vector<cv::Mat> TrackAI::Detector::PreProcess(
     std::vector<cv::Mat> outputs;
 
     // Forward pass the input blob through the model.
+    int64 start = cv::getTickCount();
     model.forward(outputs, model.getUnconnectedOutLayersNames());
+    inference_ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
 
     return outputs;  // Return the output detections
 }
 
+/**
+ * @brief Submits a frame for asynchronous inference.
+ *
+ * The blob is built on the calling thread into a free slot, so capture and
+ * preprocessing of the next frame overlap with the forward pass of the
+ * previous one. The call blocks while all slots are in flight.
+ *
+ * @param frame The input image.
+ * @return The ticket identifying the frame.
+ * @throws cv::Exception If the frame cannot be converted to a blob; the slot
+ *         is freed again.
+ */
+uint64 TrackAI::Detector::Submit(const cv::Mat &frame) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!worker.joinable()) {
+        worker = std::thread(&Detector::InferenceLoop, this);
+    }
+
+    // Wait for a free slot, bounding the number of frames in flight.
+    int free_slot = -1;
+    slot_done.wait(lock, [&] {
+        for (int i = 0; i < kMaxInFlight; ++i) {
+            if (slots[i].state == InferenceSlot::FREE) {
+                free_slot = i;
+                return true;
+            }
+        }
+        return false;
+    });
+
+    InferenceSlot &slot = slots[free_slot];
+    slot.state = InferenceSlot::QUEUED;
+    slot.ticket = next_ticket++;
+    slot.submit_tick = cv::getTickCount();
+    slot.error.clear();
+
+    // The slot is owned by this call until it is queued, so the blob can be
+    // built without holding the lock.
+    lock.unlock();
+    try {
+        cv::dnn::blobFromImage(frame, slot.blob, 1.0 / 255.0,
+                               cv::Size(input_width, input_height), cv::Scalar(),
+                               true, false);
+    } catch (...) {
+        // Give the slot back, or later calls would wait for it forever
+        lock.lock();
+        slot.state = InferenceSlot::FREE;
+        slot_done.notify_all();
+        throw;
+    }
+    lock.lock();
+
+    queue.push_back(free_slot);
+    stats.submitted++;
+    stats.in_flight++;
+    stats.max_in_flight = std::max(stats.max_in_flight, stats.in_flight);
+    work_ready.notify_one();
+    return slot.ticket;
+}
+
+/**
+ * @brief Collects the result of a submitted frame if it is ready.
+ *
+ * @param ticket The ticket returned by Submit.
+ * @param outputs Receives the raw network outputs when ready.
+ * @param completed Optional output receiving the time the forward pass finished.
+ * @return True if the result was ready and has been collected.
+ * @throws std::runtime_error If the ticket is unknown or inference failed.
+ */
+bool TrackAI::Detector::Poll(uint64 ticket, std::vector<cv::Mat> *outputs,
+    std::chrono::steady_clock::time_point *completed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int slot = FindSlot(ticket);
+    if (slot < 0) {
+        throw std::runtime_error("Unknown inference ticket");
+    }
+    if (slots[slot].state != InferenceSlot::DONE) {
+        return false;
+    }
+    *outputs = Collect(slot, completed);
+    return true;
+}
+
+/**
+ * @brief Waits for and collects the result of a submitted frame.
+ *
+ * @param ticket The ticket returned by Submit.
+ * @param completed Optional output receiving the time the forward pass finished.
+ * @return The raw network outputs, as returned by PreProcess.
+ * @throws std::runtime_error If the ticket is unknown or inference failed.
+ */
+std::vector<cv::Mat> TrackAI::Detector::Wait(uint64 ticket,
+    std::chrono::steady_clock::time_point *completed) {
+    std::unique_lock<std::mutex> lock(mutex);
+    int slot = FindSlot(ticket);
+    if (slot < 0) {
+        throw std::runtime_error("Unknown inference ticket");
+    }
+    slot_done.wait(lock, [&] {
+        return slots[slot].state == InferenceSlot::DONE;
+    });
+    return Collect(slot, completed);
+}
+
+/**
+ * @brief Returns the counters of the asynchronous inference API.
+ */
+TrackAI::AsyncStats TrackAI::Detector::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Returns the duration of the last forward pass in milliseconds.
+ */
+double TrackAI::Detector::InferenceMs() const {
+    return inference_ms;
+}
+
+/**
+ * @brief Returns the slot holding a ticket, or -1. Requires the mutex.
+ *
+ * @param ticket The ticket returned by Submit.
+ * @return The index of the slot, or -1 if no slot holds the ticket.
+ */
+int TrackAI::Detector::FindSlot(uint64 ticket) const {
+    for (int i = 0; i < kMaxInFlight; ++i) {
+        if (slots[i].state != InferenceSlot::FREE && slots[i].ticket == ticket) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Hands the outputs of a finished slot to the caller and frees it.
+ *        Requires the mutex.
+ *
+ * The outputs are shared with the caller; the inference thread only reuses
+ * their memory once the caller has released them.
+ *
+ * @param slot The index of a slot in the DONE state.
+ * @param completed Optional output receiving the time the forward pass finished.
+ * @return The raw network outputs of the slot.
+ * @throws std::runtime_error If the forward pass of the slot failed.
+ */
+std::vector<cv::Mat> TrackAI::Detector::Collect(int slot,
+    std::chrono::steady_clock::time_point *completed) {
+    InferenceSlot &done = slots[slot];
+    if (completed) *completed = done.completed;
+    std::string error = done.error;
+    std::vector<cv::Mat> outputs = done.outputs;
+
+    done.state = InferenceSlot::FREE;
+    stats.in_flight--;
+    slot_done.notify_all();
+
+    if (!error.empty()) {
+        throw std::runtime_error("Inference failed: " + error);
+    }
+    return outputs;
+}
+
+/**
+ * @brief Body of the inference thread.
+ *
+ * Runs the forward pass of every queued slot in submission order. The network
+ * outputs alias internal buffers of the network that the next forward pass
+ * overwrites, so they are copied into the slot's own output buffers.
+ */
+void TrackAI::Detector::InferenceLoop() {
+    std::vector<cv::Mat> outputs;
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        work_ready.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) return;
+
+        InferenceSlot &slot = slots[queue.front()];
+        queue.pop_front();
+        slot.state = InferenceSlot::RUNNING;
+        lock.unlock();
+
+        try {
+            int64 start = cv::getTickCount();
+            net.setInput(slot.blob);
+            net.forward(outputs, output_names);
+            inference_ms = (cv::getTickCount() - start) * 1000.0
+                           / cv::getTickFrequency();
+
+            slot.outputs.resize(outputs.size());
+            for (size_t i = 0; i < outputs.size(); ++i) {
+                // Reuse the slot buffer unless the caller still holds it.
+                if (!slot.outputs[i].empty() && slot.outputs[i].u->refcount > 1) {
+                    slot.outputs[i] = cv::Mat();
+                }
+                outputs[i].copyTo(slot.outputs[i]);
+            }
+        } catch (const cv::Exception &e) {
+            slot.error = e.what();
+        }
+        // Stamped here, since the caller may collect the result much later
+        slot.completed = std::chrono::steady_clock::now();
+
+        lock.lock();
+        double latency_ms = (cv::getTickCount() - slot.submit_tick) * 1000.0
+                            / cv::getTickFrequency();
+        stats.completed++;
+        stats.last_latency_ms = latency_ms;
+        stats.mean_latency_ms += (latency_ms - stats.mean_latency_ms)
+                                 / stats.completed;
+        slot.state = InferenceSlot::DONE;
+        slot_done.notify_all();
+    }
+}
+
 /**
  * @brief Postprocesses the detection results.
  *
@@ -113,52 +558,119 @@ cv::Mat TrackAI::Detector::PostProcess(const cv::Mat &input_image,
     float x_factor = input_image.cols / input_width;
     float y_factor = input_image.rows / input_height;
 
-    const int rows = detections[0].size[2];  // Number of detections
-    const int dimensions = detections[0].size[1];  // Detection dimensions
+    // The decoder is chosen at Load; select it here if no model was loaded
+    // or if the output does not have the shape it was chosen for.
+    const cv::Mat &output = detections[0];
+    OutputFormat format;
+    if (!decode || !DescribeOutput(output, &format) ||
+        format.layout != output_format.layout ||
+        format.anchors != output_format.anchors ||
+        format.classes != output_format.classes) {
+        SelectDecoderFor(output);
+    }
 
-    detections[0] = detections[0].reshape(1, dimensions);
-    cv::transpose(detections[0], detections[0]);
+    // Decode the candidates above the score threshold, reading the output in
+    // its native layout without transposing it.
+    DecoderParams params = {output_format.anchors, output_format.classes,
+                            x_factor, y_factor, SCORE_THRESHOLD};
+    decode(output.ptr<float>(), params, class_ids, confidences, boxes);
 
-    float *data = reinterpret_cast<float*>(detections[0].data);
+    // Perform Non-Maximum Suppression to filter overlapping bounding boxes.
+    cv::dnn::NMSBoxes(*boxes, *confidences, SCORE_THRESHOLD,
+    NMS_THRESHOLD, *indices);
 
-    // Iterate through the detections to filter low-confidence results.
-    for (int i = 0; i < rows; ++i) {
-        float *classes_scores = data + 4;
+    return input_image;  // Return the original image
+}
 
-        cv::Mat scores(1, class_list.size(), CV_32FC1, classes_scores);
-        cv::Point class_id;
-        double max_class_score;
-        cv::minMaxLoc(scores, 0, &max_class_score, 0, &class_id);
+/**
+ * @brief Runs one batched forward pass over regions of a frame.
+ *
+ * The crops are views into the frame; blobFromImages resizes each of them
+ * straight into its item of the batch blob.
+ *
+ * @param frame The full frame.
+ * @param regions The regions to detect in, inside the frame.
+ * @param region_input The network input size of a region.
+ * @param model The DNN model.
+ * @return The raw network outputs, one batch item per region.
+ */
+std::vector<cv::Mat> TrackAI::Detector::PreProcessRegions(
+    const cv::Mat &frame, const std::vector<cv::Rect> &regions,
+    cv::Size region_input, cv::dnn::Net &model) {
+    std::vector<cv::Mat> crops;
+    for (const cv::Rect &region : regions) {
+        crops.push_back(frame(region));
+    }
 
-        // Keep only the detection if the class score exceeds the threshold.
-        if (max_class_score > SCORE_THRESHOLD) {
-            // Save the class ID and confidence.
-            confidences->push_back(max_class_score);
-            class_ids->push_back(class_id.x);
+    cv::Mat blob;
+    cv::dnn::blobFromImages(crops, blob, 1.0 / 255.0, region_input,
+                            cv::Scalar(), true, false);
+    model.setInput(blob);
+    std::vector<cv::Mat> outputs;
+
+    int64 start = cv::getTickCount();
+    model.forward(outputs, model.getUnconnectedOutLayersNames());
+    inference_ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
 
-            // Extract the bounding box parameters (center, width, height).
-            float cx = data[0];  // X center
-            float cy = data[1];  // Y center
-            float w = data[2];   // Width
-            float h = data[3];   // Height
+    return outputs;
+}
+
+/**
+ * @brief Postprocesses the outputs of PreProcessRegions into frame coordinates.
+ *
+ * The region outputs have fewer anchors than the full-frame output, so they
+ * keep their own decoder instead of reselecting the full-frame one.
+ *
+ * @param detections The raw outputs returned by PreProcessRegions.
+ * @param regions The regions passed to PreProcessRegions.
+ * @param region_input The network input size of a region.
+ * @param class_ids A pointer to a vector to store detected class IDs.
+ * @param confidences A pointer to a vector to store confidence scores.
+ * @param boxes A pointer to a vector to store bounding boxes in the frame.
+ * @param indices A pointer to a vector to store indices of the filtered detections.
+ * @throws std::runtime_error If the outputs do not match the regions.
+ */
+void TrackAI::Detector::PostProcessRegions(std::vector<cv::Mat> &detections,
+    const std::vector<cv::Rect> &regions, cv::Size region_input,
+    std::vector<int> *class_ids, std::vector<float> *confidences,
+    std::vector<cv::Rect> *boxes, std::vector<int> *indices) {
+    const cv::Mat &output = detections[0];
+    if (output.dims != 3 || output.size[0] != static_cast<int>(regions.size()) ||
+        output.depth() != CV_32F || !output.isContinuous()) {
+        throw std::runtime_error("Region outputs do not match the regions");
+    }
 
-            // Map the coordinates to the original image scale.
-            int left = static_cast<int>((cx - 0.5 * w) * x_factor);
-            int top = static_cast<int>((cy - 0.5 * h) * y_factor);
-            int width = static_cast<int>(w * x_factor);
-            int height = static_cast<int>(h * y_factor);
+    const int item_shape[] = {1, output.size[1], output.size[2]};
+    const size_t item_size = static_cast<size_t>(output.size[1]) * output.size[2];
+    for (size_t r = 0; r < regions.size(); ++r) {
+        float *data = const_cast<float *>(output.ptr<float>()) + r * item_size;
+        cv::Mat item(3, item_shape, CV_32F, data);
+        OutputFormat format;
+        if (!DescribeOutput(item, &format)) {
+            throw std::runtime_error("Unsupported model output shape");
+        }
+        if (!region_decode || format.layout != region_format.layout ||
+            format.anchors != region_format.anchors ||
+            format.classes != region_format.classes) {
+            region_format = format;
+            region_decode = SelectDecoder(format, person_only);
+        }
 
-            // Store the bounding box.
-            boxes->push_back(cv::Rect(left, top, width, height));
+        // Decode relative to the crop, then move the boxes into the frame.
+        const size_t first = boxes->size();
+        DecoderParams params = {format.anchors, format.classes,
+                                regions[r].width / static_cast<float>(region_input.width),
+                                regions[r].height / static_cast<float>(region_input.height),
+                                SCORE_THRESHOLD};
+        region_decode(data, params, class_ids, confidences, boxes);
+        for (size_t i = first; i < boxes->size(); ++i) {
+            (*boxes)[i].x += regions[r].x;
+            (*boxes)[i].y += regions[r].y;
         }
-        data += dimensions;  // Move to the next detection
     }
 
-    // Perform Non-Maximum Suppression to filter overlapping bounding boxes.
     cv::dnn::NMSBoxes(*boxes, *confidences, SCORE_THRESHOLD,
     NMS_THRESHOLD, *indices);
-
-    return input_image;  // Return the original image
 }
 
 /**
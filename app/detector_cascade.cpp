@@ -0,0 +1,267 @@
+/**
+ * @file detector_cascade.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the DetectorCascade class, which falls
+ *        back from the DNN to the HOG people detector when frames take too long.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <cmath>
+#include <iostream>
+#include <opencv2/imgproc.hpp>
+#include "../include/detector_cascade.hpp"
+#include "../include/roi_refiner.hpp"
+
+namespace {
+
+    const double kEmaWeight = 0.2;          ///< Weight of the newest frame in the latency average
+    const double kRecoverRatio = 0.5;       ///< Fraction of the budget below which a dearer mode is tried
+    const float kProposalPadding = 0.25f;   ///< Context around a HOG box, relative to its size
+    const cv::Size kVerifyInput(256, 256);  ///< Network input size of a verified crop
+    const int kFullInput = 640;             ///< Network input size of a full frame
+
+}  // namespace
+
+/**
+ * @brief Constructs a cascade in DNN mode.
+ *
+ * @param budget_ms The frame latency budget in milliseconds.
+ * @param scale The downscaling factor of the frame seen by HOG.
+ */
+TrackAI::DetectorCascade::DetectorCascade(double budget_ms, double scale)
+    : scale(scale),
+      budget_ms(budget_ms),
+      latency_ema_ms(0.0),
+      over_budget_frames(0),
+      under_budget_frames(0),
+      verify_supported(true),
+      mode(CascadeMode::DNN),
+      stats{0, 0, 0, 0, 0, 0.0} {
+    hog.setSVMDetector(cv::HOGDescriptor::getDefaultPeopleDetector());
+}
+
+/**
+ * @brief Detects the people of a frame in the current mode.
+ *
+ * In VERIFY mode, a frame with so many proposals that their crops would cost
+ * as much as the full frame is detected by the full-frame DNN instead, and a
+ * model rejecting the crop batch disables VERIFY for good.
+ *
+ * @param detector The detector, loaded with the model.
+ * @param net The network returned by Detector::Load.
+ * @param frame The frame to detect in.
+ * @param class_ids A pointer to a vector to store detected class IDs.
+ * @param confidences A pointer to a vector to store confidence scores.
+ * @param boxes A pointer to a vector to store bounding boxes.
+ * @param indices A pointer to a vector to store indices of the filtered detections.
+ * @return The mode the frame was detected in.
+ */
+TrackAI::CascadeMode TrackAI::DetectorCascade::Detect(Detector &detector,
+    cv::dnn::Net &net, const cv::Mat &frame, std::vector<int> *class_ids,
+    std::vector<float> *confidences, std::vector<cv::Rect> *boxes,
+    std::vector<int> *indices) {
+    class_ids->clear();
+    confidences->clear();
+    boxes->clear();
+    indices->clear();
+
+    if (mode == CascadeMode::HOG ||
+        (mode == CascadeMode::VERIFY && !verify_supported)) {
+        DetectHog(frame, class_ids, confidences, boxes, indices);
+        stats.hog_frames++;
+        return CascadeMode::HOG;
+    }
+
+    if (mode == CascadeMode::VERIFY) {
+        DetectHog(frame, class_ids, confidences, boxes, indices);
+        proposals.clear();
+        for (int index : *indices) {
+            proposals.push_back((*boxes)[index]);
+        }
+        RoiRefiner::PlanRegions(proposals, frame.size(), kProposalPadding,
+                                &regions);
+        class_ids->clear();
+        confidences->clear();
+        boxes->clear();
+        indices->clear();
+
+        const double full_area = static_cast<double>(kFullInput) * kFullInput;
+        if (regions.empty()) {
+            stats.verify_frames++;
+            return CascadeMode::VERIFY;  // Nothing proposed, nothing to verify
+        }
+        if (regions.size() * static_cast<double>(kVerifyInput.area()) < full_area) {
+            try {
+                std::vector<cv::Mat> outputs =
+                    detector.PreProcessRegions(frame, regions, kVerifyInput, net);
+                detector.PostProcessRegions(outputs, regions, kVerifyInput,
+                                            class_ids, confidences, boxes, indices);
+                stats.proposals += proposals.size();
+                stats.verify_frames++;
+                return CascadeMode::VERIFY;
+            } catch (const std::exception &e) {
+                // Fixed-shape models reject other input or batch sizes.
+                verify_supported = false;
+                mode = CascadeMode::HOG;
+                std::cerr << "Warning: The model does not accept crop batches ("
+                          << e.what() << "), falling back to HOG alone."
+                          << std::endl;
+                class_ids->clear();
+                confidences->clear();
+                boxes->clear();
+                indices->clear();
+                DetectHog(frame, class_ids, confidences, boxes, indices);
+                stats.hog_frames++;
+                return CascadeMode::HOG;
+            }
+        }
+        // Too many proposals: the full frame is cheaper than their crops.
+    }
+
+    cv::Mat input = frame;
+    std::vector<cv::Mat> outputs = detector.PreProcess(input, net);
+    detector.PostProcess(frame, outputs, class_ids, confidences, boxes, indices);
+    stats.dnn_frames++;
+    return CascadeMode::DNN;
+}
+
+/**
+ * @brief Runs the HOG people detector alone.
+ *
+ * The frame is downscaled first, which makes the 64 x 128 detection window
+ * match people twice as tall at the default scale and divides the work by
+ * the square of the factor. The HOG windows include a margin around the
+ * person, so the boxes are tightened like in OpenCV's people detection
+ * sample before being mapped back to the frame.
+ *
+ * @param frame The frame to detect in.
+ * @param class_ids A pointer to a vector to store the person class ID.
+ * @param confidences A pointer to a vector to store confidence scores.
+ * @param boxes A pointer to a vector to store bounding boxes.
+ * @param indices A pointer to a vector to store indices of the filtered detections.
+ */
+void TrackAI::DetectorCascade::DetectHog(const cv::Mat &frame,
+    std::vector<int> *class_ids, std::vector<float> *confidences,
+    std::vector<cv::Rect> *boxes, std::vector<int> *indices) {
+    cv::Mat small;
+    cv::resize(frame, small, cv::Size(), scale, scale, cv::INTER_LINEAR);
+
+    std::vector<cv::Rect> found;
+    std::vector<double> weights;
+    hog.detectMultiScale(small, found, weights, 0.0, cv::Size(8, 8),
+                         cv::Size(8, 8), 1.05, 2);
+
+    for (size_t i = 0; i < found.size(); ++i) {
+        const cv::Rect &window = found[i];
+        cv::Rect box(static_cast<int>((window.x + 0.1 * window.width) / scale),
+                     static_cast<int>((window.y + 0.07 * window.height) / scale),
+                     static_cast<int>(0.8 * window.width / scale),
+                     static_cast<int>(0.8 * window.height / scale));
+        class_ids->push_back(0);  // Person
+        confidences->push_back(static_cast<float>(
+            1.0 / (1.0 + std::exp(-(i < weights.size() ? weights[i] : 0.0)))));
+        boxes->push_back(box & cv::Rect(0, 0, frame.cols, frame.rows));
+    }
+
+    // Grouping already merged overlapping windows; drop nested leftovers.
+    cv::dnn::NMSBoxes(*boxes, *confidences, 0.0f, 0.5f, *indices);
+}
+
+/**
+ * @brief Feeds the latency of a frame to the mode control.
+ *
+ * @param frame_ms The time from capture to result of the frame in milliseconds.
+ * @return The mode for the next frame.
+ */
+TrackAI::CascadeMode TrackAI::DetectorCascade::ReportLatency(double frame_ms) {
+    latency_ema_ms = latency_ema_ms > 0.0
+        ? kEmaWeight * frame_ms + (1.0 - kEmaWeight) * latency_ema_ms
+        : frame_ms;
+    stats.latency_ema_ms = latency_ema_ms;
+    if (budget_ms <= 0.0) return mode;
+
+    over_budget_frames = latency_ema_ms > budget_ms ? over_budget_frames + 1 : 0;
+    under_budget_frames = latency_ema_ms < kRecoverRatio * budget_ms
+                          ? under_budget_frames + 1 : 0;
+
+    CascadeMode next = mode;
+    if (over_budget_frames >= kDegradeAfterFrames && mode != CascadeMode::HOG) {
+        next = static_cast<CascadeMode>(static_cast<int>(mode) + 1);
+        if (next == CascadeMode::VERIFY && !verify_supported) {
+            next = CascadeMode::HOG;
+        }
+    } else if (under_budget_frames >= kRecoverAfterFrames &&
+               mode != CascadeMode::DNN) {
+        next = static_cast<CascadeMode>(static_cast<int>(mode) - 1);
+        if (next == CascadeMode::VERIFY && !verify_supported) {
+            next = CascadeMode::DNN;
+        }
+    }
+
+    if (next != mode) {
+        std::cout << "Frames took " << latency_ema_ms << " ms on average (budget "
+                  << budget_ms << " ms), switching detection from "
+                  << ModeName(mode) << " to " << ModeName(next) << std::endl;
+        mode = next;
+        stats.switches++;
+        over_budget_frames = 0;
+        under_budget_frames = 0;
+    }
+    return mode;
+}
+
+/**
+ * @brief Returns the current mode.
+ */
+TrackAI::CascadeMode TrackAI::DetectorCascade::Mode() const {
+    return mode;
+}
+
+/**
+ * @brief Forces a mode, e.g. to benchmark it.
+ *
+ * @param new_mode The mode for the next frame.
+ */
+void TrackAI::DetectorCascade::SetMode(CascadeMode new_mode) {
+    mode = new_mode;
+    over_budget_frames = 0;
+    under_budget_frames = 0;
+}
+
+/**
+ * @brief Sets the frame latency budget.
+ *
+ * @param new_budget_ms The budget in milliseconds, zero to disable switching.
+ */
+void TrackAI::DetectorCascade::SetBudget(double new_budget_ms) {
+    budget_ms = new_budget_ms;
+    over_budget_frames = 0;
+    under_budget_frames = 0;
+}
+
+/**
+ * @brief Returns the counters of the cascade.
+ */
+TrackAI::CascadeStats TrackAI::DetectorCascade::Stats() const {
+    return stats;
+}
+
+/**
+ * @brief Returns the human readable name of a mode.
+ *
+ * @param mode The mode to name.
+ * @return The name of the mode.
+ */
+std::string TrackAI::DetectorCascade::ModeName(CascadeMode mode) {
+    switch (mode) {
+        case CascadeMode::VERIFY:
+            return "HOG+DNN";
+        case CascadeMode::HOG:
+            return "HOG";
+        case CascadeMode::DNN:
+        default:
+            return "DNN";
+    }
+}
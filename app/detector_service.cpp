@@ -0,0 +1,201 @@
+/**
+ * @file detector_service.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the DetectorService class, a thread-safe
+ *        pool of detectors loaded from one model.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "../include/detector_service.hpp"
+
+/**
+ * @brief Constructs an empty service.
+ */
+TrackAI::DetectorService::DetectorService()
+    : stats{0, 0, 0, 0, 0, 0.0, 0.0} {}
+
+/**
+ * @brief Loads the model into a pool of replicas.
+ *
+ * The model file is read once; every replica parses the same buffer, and all
+ * replicas after the first take their layer weights from the first one. The
+ * resident memory is sampled after each replica has run its warm-up pass.
+ *
+ * @param model_path The path to the ONNX model file.
+ * @param replica_count The number of replicas, at least one.
+ * @param person_only Whether only the person class is decoded.
+ * @param prune_head Whether the output is sliced to the person channels.
+ * @throws std::runtime_error If the model cannot be read or loaded.
+ */
+void TrackAI::DetectorService::Load(const std::string &model_path,
+    size_t replica_count, bool person_only, bool prune_head) {
+    std::ifstream file(model_path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to read model: " + model_path);
+    }
+    std::vector<uchar> model_data((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+    if (replica_count == 0) replica_count = 1;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stats.busy > 0) {
+        throw std::runtime_error("Cannot reload a service that is in use");
+    }
+    replicas.clear();
+    nets.clear();
+    idle.clear();
+
+    std::vector<double> growth_mb;
+    double resident_mb = ResidentMb();
+    for (size_t i = 0; i < replica_count; ++i) {
+        std::unique_ptr<Detector> replica(new Detector());
+        const Detector *weights = replicas.empty() ? nullptr : replicas[0].get();
+        nets.push_back(replica->Load(model_data, person_only, prune_head,
+                                     weights));
+        replicas.push_back(std::move(replica));
+        idle.push_back(i);
+
+        double now_mb = ResidentMb();
+        growth_mb.push_back(now_mb - resident_mb);
+        resident_mb = now_mb;
+    }
+
+    stats = ServiceStats{replica_count, 0, 0, 0, 0, growth_mb[0], 0.0};
+    for (size_t i = 1; i < growth_mb.size(); ++i) {
+        stats.per_replica_mb += growth_mb[i] / (growth_mb.size() - 1);
+    }
+    std::printf("Detector service: %zu replicas, first %.1f MiB, "
+                "%.1f MiB per additional replica\n", replica_count,
+                stats.first_replica_mb, stats.per_replica_mb);
+}
+
+/**
+ * @brief Runs the forward pass of a frame on a free replica.
+ *
+ * @param frame The input image.
+ * @return The raw network outputs, as returned by Detector::PreProcess.
+ */
+std::vector<cv::Mat> TrackAI::DetectorService::Infer(const cv::Mat &frame) {
+    size_t replica = Checkout();
+    std::vector<cv::Mat> outputs;
+    try {
+        cv::Mat input = frame;
+        outputs = replicas[replica]->PreProcess(input, nets[replica]);
+        // The outputs may alias the buffers of the network, which the next
+        // caller of this replica overwrites.
+        for (cv::Mat &output : outputs) {
+            output = output.clone();
+        }
+    } catch (...) {
+        Release(replica);
+        throw;
+    }
+    Release(replica);
+    return outputs;
+}
+
+/**
+ * @brief Detects the objects of a frame on a free replica.
+ *
+ * @param frame The input image.
+ * @param class_ids A pointer to a vector to store detected class IDs.
+ * @param confidences A pointer to a vector to store confidence scores.
+ * @param boxes A pointer to a vector to store bounding boxes.
+ * @param indices A pointer to a vector to store indices of the filtered detections.
+ */
+void TrackAI::DetectorService::Detect(const cv::Mat &frame,
+    std::vector<int> *class_ids, std::vector<float> *confidences,
+    std::vector<cv::Rect> *boxes, std::vector<int> *indices) {
+    size_t replica = Checkout();
+    try {
+        cv::Mat input = frame;
+        std::vector<cv::Mat> outputs =
+            replicas[replica]->PreProcess(input, nets[replica]);
+        replicas[replica]->PostProcess(frame, outputs, class_ids, confidences,
+                                       boxes, indices);
+    } catch (...) {
+        Release(replica);
+        throw;
+    }
+    Release(replica);
+}
+
+/**
+ * @brief Returns the class names reported by the replicas.
+ */
+std::vector<std::string> TrackAI::DetectorService::ClassList() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return replicas.empty() ? std::vector<std::string>()
+                            : replicas[0]->class_list;
+}
+
+/**
+ * @brief Returns the counters and memory usage of the service.
+ */
+TrackAI::ServiceStats TrackAI::DetectorService::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Returns the current resident memory of the process in MiB.
+ *
+ * @return The resident set size, or 0 if it cannot be read.
+ */
+double TrackAI::DetectorService::ResidentMb() {
+    unsigned long total_pages = 0;
+    unsigned long resident_pages = 0;
+    FILE *statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0.0;
+    int fields = std::fscanf(statm, "%lu %lu", &total_pages, &resident_pages);
+    std::fclose(statm);
+    if (fields != 2) return 0.0;
+    return resident_pages * static_cast<double>(sysconf(_SC_PAGESIZE)) /
+           (1024.0 * 1024.0);
+}
+
+/**
+ * @brief Waits for a free replica and marks it busy.
+ *
+ * @return The index of the checked out replica.
+ * @throws std::runtime_error If no model has been loaded.
+ */
+size_t TrackAI::DetectorService::Checkout() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (replicas.empty()) {
+        throw std::runtime_error("Detector service used before Load");
+    }
+    if (idle.empty()) {
+        stats.waited++;
+        replica_free.wait(lock, [this] { return !idle.empty(); });
+    }
+
+    size_t replica = idle.back();
+    idle.pop_back();
+    stats.busy++;
+    stats.peak_busy = std::max(stats.peak_busy, stats.busy);
+    return replica;
+}
+
+/**
+ * @brief Returns a replica to the pool.
+ *
+ * @param replica The index returned by Checkout.
+ */
+void TrackAI::DetectorService::Release(size_t replica) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(replica);
+        stats.busy--;
+        stats.calls++;
+    }
+    replica_free.notify_one();
+}
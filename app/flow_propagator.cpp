@@ -0,0 +1,222 @@
+/**
+ * @file flow_propagator.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the FlowPropagator class, which
+ *        propagates bounding boxes between detector keyframes with sparse optical flow.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include "../include/flow_propagator.hpp"
+
+namespace {
+
+/**
+ * @brief Converts a frame to a single channel grayscale image.
+ *
+ * @param frame The BGR, BGRA or grayscale input frame.
+ * @param gray The grayscale output image.
+ */
+void ToGray(const cv::Mat &frame, cv::Mat *gray) {
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame, *gray, cv::COLOR_BGR2GRAY);
+    } else if (frame.channels() == 4) {
+        cv::cvtColor(frame, *gray, cv::COLOR_BGRA2GRAY);
+    } else {
+        *gray = frame;
+    }
+}
+
+/**
+ * @brief Returns the median of a set of values, reordering them in place.
+ *
+ * @param values The values, must not be empty.
+ * @return The median value.
+ */
+float Median(std::vector<float> *values) {
+    auto middle = values->begin() + values->size() / 2;
+    std::nth_element(values->begin(), middle, values->end());
+    return *middle;
+}
+
+}  // namespace
+
+/**
+ * @brief Constructs a FlowPropagator with default tracking parameters.
+ *
+ * Uses a 15x15 search window over three pyramid levels, at most 20 points
+ * per box and a forward-backward threshold of one pixel.
+ */
+TrackAI::FlowPropagator::FlowPropagator()
+    : win_size(15, 15),
+      max_level(3),
+      max_points(20),
+      fb_threshold(1.0f),
+      last_propagate_ms(0.0) {}
+
+/**
+ * @brief Selects the feature points of every target in a grayscale frame.
+ *
+ * Corners are preferred; boxes with too little texture fall back to a
+ * regular grid of points.
+ *
+ * @param gray The grayscale frame.
+ */
+void TrackAI::FlowPropagator::SeedPoints(const cv::Mat &gray) {
+    const cv::Rect image_rect(0, 0, gray.cols, gray.rows);
+    std::vector<cv::Point2f> corners;
+
+    prev_points.clear();
+    point_offsets.clear();
+    for (const cv::Rect &box : boxes) {
+        point_offsets.push_back(static_cast<int>(prev_points.size()));
+        cv::Rect roi = box & image_rect;
+        if (roi.width < 4 || roi.height < 4) continue;
+
+        double min_distance = std::max(2, std::min(roi.width, roi.height) / 10);
+        cv::goodFeaturesToTrack(gray(roi), corners, max_points, 0.01,
+                                min_distance);
+        if (corners.size() < 4) {
+            // Not enough texture, use a 4x4 grid inside the box instead.
+            corners.clear();
+            for (int gy = 1; gy <= 4; ++gy) {
+                for (int gx = 1; gx <= 4; ++gx) {
+                    corners.push_back(cv::Point2f(roi.width * gx / 5.0f,
+                                                  roi.height * gy / 5.0f));
+                }
+            }
+        }
+        for (const cv::Point2f &corner : corners) {
+            prev_points.push_back(corner + cv::Point2f(roi.tl()));
+        }
+    }
+    point_offsets.push_back(static_cast<int>(prev_points.size()));
+}
+
+/**
+ * @brief Starts propagating the given boxes from a keyframe.
+ *
+ * @param frame The frame the boxes were detected in.
+ * @param bboxes The bounding boxes of the targets.
+ */
+void TrackAI::FlowPropagator::Init(const cv::Mat &frame,
+    const std::vector<cv::Rect> &bboxes) {
+    cv::Mat gray;
+    ToGray(frame, &gray);
+    cv::buildOpticalFlowPyramid(gray, prev_pyramid, win_size, max_level);
+
+    boxes = bboxes;
+    quality.assign(boxes.size(), 1.0f);
+    SeedPoints(gray);
+}
+
+/**
+ * @brief Propagates every box to a new frame.
+ *
+ * The pyramid of the new frame is built once and the points of all targets
+ * are tracked forward and backward in two batched calls. Each box is then
+ * moved by the median displacement and scaled by the median ratio of
+ * pairwise point distances of its consistent points.
+ *
+ * @param frame The new frame.
+ * @return The propagated bounding box of every target.
+ */
+const std::vector<cv::Rect>& TrackAI::FlowPropagator::Propagate(
+    const cv::Mat &frame) {
+    int64 start = cv::getTickCount();
+
+    cv::Mat gray;
+    ToGray(frame, &gray);
+    int levels = cv::buildOpticalFlowPyramid(gray, next_pyramid, win_size,
+                                             max_level);
+
+    if (!prev_points.empty()) {
+        cv::calcOpticalFlowPyrLK(prev_pyramid, next_pyramid, prev_points,
+                                 next_points, status, error, win_size, levels);
+        cv::calcOpticalFlowPyrLK(next_pyramid, prev_pyramid, next_points,
+                                 back_points, back_status, error, win_size,
+                                 levels);
+    }
+
+    std::vector<float> dx, dy, scales;
+    std::vector<int> valid;
+    for (size_t t = 0; t < boxes.size(); ++t) {
+        const int first = point_offsets[t];
+        const int last = point_offsets[t + 1];
+
+        // Keep the points that survive the forward-backward check.
+        dx.clear();
+        dy.clear();
+        valid.clear();
+        for (int i = first; i < last; ++i) {
+            if (!status[i] || !back_status[i]) continue;
+            cv::Point2f fb = prev_points[i] - back_points[i];
+            if (fb.dot(fb) > fb_threshold * fb_threshold) continue;
+            dx.push_back(next_points[i].x - prev_points[i].x);
+            dy.push_back(next_points[i].y - prev_points[i].y);
+            valid.push_back(i);
+        }
+
+        if (valid.size() < 3) {
+            quality[t] = 0.0f;  // Too few points, keep the previous box
+            continue;
+        }
+        quality[t] = static_cast<float>(valid.size()) / (last - first);
+
+        // Scale change from the ratios of pairwise distances.
+        scales.clear();
+        for (size_t a = 0; a < valid.size(); ++a) {
+            for (size_t b = a + 1; b < valid.size(); ++b) {
+                cv::Point2f before = prev_points[valid[a]] - prev_points[valid[b]];
+                cv::Point2f after = next_points[valid[a]] - next_points[valid[b]];
+                float distance = std::sqrt(before.dot(before));
+                if (distance > 1.0f) {
+                    scales.push_back(std::sqrt(after.dot(after)) / distance);
+                }
+            }
+        }
+        float scale = scales.empty() ? 1.0f : Median(&scales);
+
+        cv::Rect &box = boxes[t];
+        float cx = box.x + 0.5f * box.width + Median(&dx);
+        float cy = box.y + 0.5f * box.height + Median(&dy);
+        float w = box.width * scale;
+        float h = box.height * scale;
+        box = cv::Rect(cvRound(cx - 0.5f * w), cvRound(cy - 0.5f * h),
+                       cvRound(w), cvRound(h));
+    }
+
+    // The current frame becomes the reference for the next propagation.
+    std::swap(prev_pyramid, next_pyramid);
+    SeedPoints(gray);
+
+    last_propagate_ms = (cv::getTickCount() - start) * 1000.0
+                        / cv::getTickFrequency();
+    return boxes;
+}
+
+/**
+ * @brief Returns the quality score of every target in [0, 1].
+ */
+const std::vector<float>& TrackAI::FlowPropagator::Quality() const {
+    return quality;
+}
+
+/**
+ * @brief Returns the current bounding box of every target.
+ */
+const std::vector<cv::Rect>& TrackAI::FlowPropagator::Boxes() const {
+    return boxes;
+}
+
+/**
+ * @brief Returns the time spent in the last Propagate call in milliseconds.
+ */
+double TrackAI::FlowPropagator::LastPropagateMs() const {
+    return last_propagate_ms;
+}
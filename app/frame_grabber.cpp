@@ -0,0 +1,187 @@
+/**
+ * @file frame_grabber.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the FrameGrabber class, which keeps
+ *        the most recent camera frame on a dedicated capture thread.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include <iostream>
+#include "../include/frame_grabber.hpp"
+
+/**
+ * @brief Constructs an idle FrameGrabber.
+ */
+TrackAI::FrameGrabber::FrameGrabber()
+    : has_latest(false), running(false), finished(true) {
+    latest.sequence = 0;
+    stats = GrabberStats{0, 0, 0, 0, 0, 0.0, 0.0, 0.0};
+}
+
+/**
+ * @brief Stops the capture thread and releases the camera.
+ */
+TrackAI::FrameGrabber::~FrameGrabber() {
+    Close();
+}
+
+/**
+ * @brief Opens a camera and starts the capture thread.
+ *
+ * The first frame is read synchronously to size the buffer pool.
+ *
+ * @param device The index of the camera.
+ * @return False if the camera could not be opened or read.
+ */
+bool TrackAI::FrameGrabber::Open(int device) {
+    Close();
+    if (!capture.open(device)) {
+        return false;
+    }
+
+    cv::Mat first;
+    if (!capture.read(first) || first.empty()) {
+        capture.release();
+        return false;
+    }
+    pool.reset(new FramePool(kPoolSize, first.size(), first.type(),
+                             PoolPolicy::DROP));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    latest.image = first;
+    latest.sequence = 0;
+    latest.captured = std::chrono::steady_clock::now();
+    has_latest = true;
+    running = true;
+    finished = false;
+    stats = GrabberStats{1, 0, 0, 0, 0, 0.0, 0.0, 0.0};
+    worker = std::thread(&FrameGrabber::CaptureLoop, this);
+    return true;
+}
+
+/**
+ * @brief Stops the capture thread and releases the camera.
+ */
+void TrackAI::FrameGrabber::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (capture.isOpened()) {
+        capture.release();
+    }
+}
+
+/**
+ * @brief Body of the capture thread.
+ *
+ * Reads frames into pooled buffers and publishes each one as the latest
+ * frame, replacing any frame the processing loop has not picked up yet.
+ */
+void TrackAI::FrameGrabber::CaptureLoop() {
+    uint64 sequence = 1;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) break;
+        }
+
+        cv::Mat image;
+        if (!pool->Acquire(&image)) {
+            // Every buffer is still in use downstream: skip this camera frame.
+            bool grabbed = capture.grab();
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.dropped++;
+            if (!grabbed) break;
+            continue;
+        }
+        if (!capture.read(image)) break;
+        auto captured = std::chrono::steady_clock::now();
+
+        // A camera that changed resolution, or a backend that allocates its
+        // own output, leaves the pooled buffer unused.
+        bool pooled = pool->Owns(image);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!pooled && stats.reallocated++ == 0) {
+            std::cerr << "Warning: The camera frame " << image.cols << "x"
+                      << image.rows << " was not read into the frame pool, "
+                      << "capture allocates every frame." << std::endl;
+        }
+        if (has_latest) {
+            stats.dropped++;  // The previous frame was never processed
+        }
+        latest.image = image;
+        latest.sequence = sequence++;
+        latest.captured = captured;
+        has_latest = true;
+        stats.captured++;
+        frame_ready.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    frame_ready.notify_all();
+}
+
+/**
+ * @brief Waits for a frame newer than the last delivered one.
+ *
+ * @param frame Receives the freshest frame.
+ * @return False once the camera stopped delivering frames.
+ */
+bool TrackAI::FrameGrabber::Next(StampedFrame *frame) {
+    std::unique_lock<std::mutex> lock(mutex);
+    frame_ready.wait(lock, [this] { return has_latest || finished; });
+    if (!has_latest) {
+        return false;
+    }
+
+    *frame = latest;
+    latest.image = cv::Mat();  // Hand the buffer over to the caller
+    has_latest = false;
+    stats.delivered++;
+    return true;
+}
+
+/**
+ * @brief Records that the result of a frame is available.
+ *
+ * @param frame The frame whose processing finished.
+ * @return The capture-to-result age of the frame in milliseconds.
+ */
+double TrackAI::FrameGrabber::ReportResult(const StampedFrame &frame) {
+    double age_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - frame.captured).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.results++;
+    stats.last_age_ms = age_ms;
+    stats.mean_age_ms += (age_ms - stats.mean_age_ms) / stats.results;
+    stats.max_age_ms = std::max(stats.max_age_ms, age_ms);
+    return age_ms;
+}
+
+/**
+ * @brief Returns the capture counters and frame age statistics.
+ */
+TrackAI::GrabberStats TrackAI::FrameGrabber::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Returns the utilization counters of the capture buffer pool.
+ */
+TrackAI::PoolStats TrackAI::FrameGrabber::PoolUsage() {
+    if (!pool) {
+        return PoolStats{0, 0, 0, 0, 0, 0};
+    }
+    return pool->Stats();
+}
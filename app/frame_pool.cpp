@@ -0,0 +1,109 @@
+/**
+ * @file frame_pool.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the FramePool class, which recycles
+ *        pre-allocated frame buffers for the capture loop.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "../include/frame_pool.hpp"
+
+/**
+ * @brief Constructs a pool of pre-allocated buffers.
+ *
+ * @param capacity The number of buffers.
+ * @param size The size of every buffer.
+ * @param type The OpenCV type of every buffer, e.g. CV_8UC3.
+ * @param policy What to do when every buffer is in use.
+ * @param block_timeout_ms The longest wait of the BLOCK policy.
+ */
+TrackAI::FramePool::FramePool(size_t capacity, cv::Size size, int type,
+    PoolPolicy policy, double block_timeout_ms)
+    : policy(policy), block_timeout_ms(block_timeout_ms), next(0) {
+    for (size_t i = 0; i < capacity; ++i) {
+        buffers.push_back(cv::Mat(size, type));
+    }
+    stats = PoolStats{capacity, 0, 0, 0, 0, 0};
+}
+
+/**
+ * @brief Hands out a free buffer.
+ *
+ * A buffer is free when the pool holds its only reference. The search is
+ * round robin so that buffers are reused evenly.
+ *
+ * @param frame Receives a header sharing the buffer memory.
+ * @return False if the pool is exhausted and the frame must be dropped.
+ */
+bool TrackAI::FramePool::Acquire(cv::Mat *frame) {
+    auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(static_cast<int64>(block_timeout_ms * 1000));
+    bool waited = false;
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t n = 0; n < buffers.size(); ++n) {
+                size_t i = (next + n) % buffers.size();
+                if (buffers[i].u->refcount == 1) {
+                    *frame = buffers[i];
+                    next = (i + 1) % buffers.size();
+                    stats.acquired++;
+                    stats.waited += waited ? 1 : 0;
+                    stats.peak_in_use = std::max(stats.peak_in_use, CountInUse());
+                    return true;
+                }
+            }
+
+            if (policy == PoolPolicy::DROP ||
+                std::chrono::steady_clock::now() >= deadline) {
+                stats.dropped++;
+                return false;
+            }
+        }
+
+        // Downstream stages release buffers on their own threads; poll for it.
+        waited = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+/**
+ * @brief Returns whether a frame still uses the memory of a pool buffer.
+ *
+ * @param frame The frame to check.
+ * @return True if the frame data lies in one of the buffers.
+ */
+bool TrackAI::FramePool::Owns(const cv::Mat &frame) const {
+    for (const cv::Mat &buffer : buffers) {
+        if (frame.u == buffer.u) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the utilization counters of the pool.
+ */
+TrackAI::PoolStats TrackAI::FramePool::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    PoolStats current = stats;
+    current.in_use = CountInUse();
+    return current;
+}
+
+/**
+ * @brief Returns the number of buffers referenced outside the pool.
+ *        Requires the mutex.
+ */
+size_t TrackAI::FramePool::CountInUse() const {
+    size_t in_use = 0;
+    for (const cv::Mat &buffer : buffers) {
+        if (buffer.u->refcount > 1) in_use++;
+    }
+    return in_use;
+}
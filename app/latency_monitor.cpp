@@ -0,0 +1,143 @@
+/**
+ * @file latency_monitor.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the LatencyMonitor class, which keeps
+ *        rolling percentiles of the capture-to-result age of the frames.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include "../include/latency_monitor.hpp"
+
+namespace {
+
+    const int kStages = 4;   ///< Wait, inference, decode and track
+
+    /**
+     * @brief Converts a duration into saturated record latency units.
+     */
+    uint16_t Units(double ms) {
+        const double units = ms * 1000.0 / TrackAI::kLatencyUnitUs + 0.5;
+        return units >= 65535.0 ? 65535 : static_cast<uint16_t>(units);
+    }
+
+}  // namespace
+
+/**
+ * @brief Constructs an empty monitor.
+ *
+ * @param window The number of most recent frames summarized.
+ */
+TrackAI::LatencyMonitor::LatencyMonitor(size_t window)
+    : capacity(std::max<size_t>(window, 1)),
+      next(0),
+      frames(0),
+      ages_ms(capacity, 0.0),
+      stages_ms(capacity * kStages, 0.0) {}
+
+/**
+ * @brief Records the timestamps of a finished frame.
+ *
+ * @param stamps The timestamps of the frame, up to emitted.
+ * @return The end-to-end age of the frame in milliseconds.
+ */
+double TrackAI::LatencyMonitor::Add(const FrameStamps &stamps) {
+    const double age_ms = Ms(stamps.captured, stamps.emitted);
+    std::lock_guard<std::mutex> lock(mutex);
+    ages_ms[next] = age_ms;
+    double *stage = &stages_ms[next * kStages];
+    stage[0] = Ms(stamps.captured, stamps.started);
+    stage[1] = Ms(stamps.started, stamps.inferred);
+    stage[2] = Ms(stamps.inferred, stamps.decoded);
+    stage[3] = Ms(stamps.decoded, stamps.emitted);
+    next = (next + 1) % capacity;
+    frames++;
+    return age_ms;
+}
+
+/**
+ * @brief Summarizes the frames in the rolling window.
+ *
+ * Percentiles use the nearest rank, like the benchmark summaries.
+ */
+TrackAI::LatencySummary TrackAI::LatencyMonitor::Summary() const {
+    LatencySummary summary = {0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    std::vector<double> sorted;
+    double stage_sums[kStages] = {0.0, 0.0, 0.0, 0.0};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        summary.frames = frames;
+        summary.window = static_cast<size_t>(std::min<uint64_t>(frames, capacity));
+        sorted.assign(ages_ms.begin(), ages_ms.begin() + summary.window);
+        for (size_t i = 0; i < summary.window; ++i) {
+            for (int k = 0; k < kStages; ++k) {
+                stage_sums[k] += stages_ms[i * kStages + k];
+            }
+        }
+    }
+    if (sorted.empty()) return summary;
+
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+        return sorted[static_cast<size_t>(p * (sorted.size() - 1) + 0.5)];
+    };
+    summary.p50_ms = percentile(0.50);
+    summary.p90_ms = percentile(0.90);
+    summary.p99_ms = percentile(0.99);
+    summary.max_ms = sorted.back();
+    summary.wait_ms = stage_sums[0] / sorted.size();
+    summary.inference_ms = stage_sums[1] / sorted.size();
+    summary.decode_ms = stage_sums[2] / sorted.size();
+    summary.track_ms = stage_sums[3] / sorted.size();
+    return summary;
+}
+
+/**
+ * @brief Forgets every frame.
+ */
+void TrackAI::LatencyMonitor::Reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    next = 0;
+    frames = 0;
+}
+
+/**
+ * @brief Starts the timestamps of a frame at its capture.
+ *
+ * @param sequence The capture sequence number of the frame.
+ * @param captured The time the frame was read from the camera.
+ * @return The timestamps of the frame.
+ */
+TrackAI::FrameStamps TrackAI::LatencyMonitor::Begin(uint64_t sequence,
+    std::chrono::steady_clock::time_point captured) {
+    return FrameStamps{sequence, captured, captured, captured, captured, captured};
+}
+
+/**
+ * @brief Stores the stage durations of a frame in a detection record.
+ *
+ * @param stamps The timestamps of the frame, up to emitted.
+ * @param record The record to fill in.
+ */
+void TrackAI::LatencyMonitor::Encode(const FrameStamps &stamps,
+    DetectionRecord *record) {
+    record->wait_latency = Units(Ms(stamps.captured, stamps.started));
+    record->inference_latency = Units(Ms(stamps.started, stamps.inferred));
+    record->decode_latency = Units(Ms(stamps.inferred, stamps.decoded));
+    record->track_latency = Units(Ms(stamps.decoded, stamps.emitted));
+}
+
+/**
+ * @brief Returns the time between two stamps in milliseconds.
+ *
+ * @param from The earlier stamp.
+ * @param to The later stamp.
+ * @return The elapsed time, or zero if the stamps are out of order.
+ */
+double TrackAI::LatencyMonitor::Ms(std::chrono::steady_clock::time_point from,
+    std::chrono::steady_clock::time_point to) {
+    return to > from
+        ? std::chrono::duration<double, std::milli>(to - from).count() : 0.0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file log_dump.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the command line tool that streams a binary results
+ *        log out as CSV or JSON.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * Usage: trackAI-log <log> [--json] [--frame N]
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "../include/results_log.hpp"
+
+namespace {
+
+/**
+ * @brief Prints one record as a CSV line or a JSON object.
+ *
+ * @param record The record to print.
+ * @param json Whether to print JSON instead of CSV.
+ * @param first Whether this is the first JSON object of the array.
+ */
+void PrintRecord(const TrackAI::DetectionRecord &record, bool json,
+    bool first) {
+    const double unit_ms = TrackAI::kLatencyUnitUs / 1000.0;
+    const double wait_ms = record.wait_latency * unit_ms;
+    const double inference_ms = record.inference_latency * unit_ms;
+    const double decode_ms = record.decode_latency * unit_ms;
+    const double track_ms = record.track_latency * unit_ms;
+    if (json) {
+        std::printf("%s\n  {\"frame\": %" PRIu64 ", \"timestamp_ns\": %" PRId64
+                    ", \"box\": [%g, %g, %g, %g], \"confidence\": %g, "
+                    "\"class\": %d, \"track\": %d, \"robot\": [%g, %g, %g], "
+                    "\"latency_ms\": {\"wait\": %g, \"inference\": %g, "
+                    "\"decode\": %g, \"track\": %g}}",
+                    first ? "" : ",", record.frame_index, record.timestamp_ns,
+                    record.x, record.y, record.width, record.height,
+                    record.confidence, record.class_id, record.track_id,
+                    record.robot_x, record.robot_y, record.robot_z,
+                    wait_ms, inference_ms, decode_ms, track_ms);
+    } else {
+        std::printf("%" PRIu64 ",%" PRId64 ",%g,%g,%g,%g,%g,%d,%d,%g,%g,%g,"
+                    "%g,%g,%g,%g\n",
+                    record.frame_index, record.timestamp_ns, record.x, record.y,
+                    record.width, record.height, record.confidence,
+                    record.class_id, record.track_id, record.robot_x,
+                    record.robot_y, record.robot_z, wait_ms, inference_ms,
+                    decode_ms, track_ms);
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Streams a results log, or a single frame of it, to stdout.
+ *
+ * @param argc Argument count from the command line.
+ * @param argv Argument vector: the log path, optionally --json and --frame N.
+ * @return int Returns 0 on success and 1 if the log could not be read.
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <log> [--json] [--frame N]\n", argv[0]);
+        return 1;
+    }
+
+    bool json = false;
+    bool single_frame = false;
+    uint64_t frame = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (std::strcmp(argv[i], "--frame") == 0 && i + 1 < argc) {
+            single_frame = true;
+            frame = std::strtoull(argv[++i], nullptr, 10);
+        }
+    }
+
+    TrackAI::ResultsLogReader reader;
+    if (!reader.Open(argv[1])) {
+        std::fprintf(stderr, "Could not read results log %s\n", argv[1]);
+        return 1;
+    }
+
+    // Either every record, or the records of one frame found through the index.
+    const TrackAI::DetectionRecord *first = nullptr;
+    uint64_t count = reader.Records();
+    if (count > 0) first = &reader.Record(0);
+    if (single_frame) {
+        uint32_t frame_count = 0;
+        first = reader.Frame(frame, &frame_count);
+        count = frame_count;
+    }
+
+    if (json) {
+        std::printf("[");
+    } else {
+        std::printf("frame,timestamp_ns,x,y,width,height,confidence,class,"
+                    "track,robot_x,robot_y,robot_z,wait_ms,inference_ms,"
+                    "decode_ms,track_ms\n");
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        PrintRecord(first[i], json, i == 0);
+    }
+    if (json) {
+        std::printf("\n]\n");
+    }
+    return 0;
+}
@@ -10,6 +10,8 @@
  * the Robot object and starting the robot's operation.
  */
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include "../include/robot.hpp"
 
@@ -19,10 +21,26 @@
  * Initializes a Robot instance and calls the Run method to start the 
  * detection and tracking process.
  *
- * @return int Returns 0 upon successful execution.
+ * @param argc Argument count from the command line.
+ * @param argv Argument vector: optionally --refine, to detect the tracked
+ *             people from crops around their predicted boxes, and
+ *             --overload-budget MS, to fall back to HOG-based detection
+ *             while the frame latency stays above MS milliseconds.
+ * @return int Returns 0 upon successful execution and 1 on an unknown option.
  */
-int main() {
+int main(int argc, char** argv) {
     TrackAI::Robot robot;  // Create an instance of the Robot class
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--refine") == 0) {
+            robot.SetRefinement(true);
+        } else if (std::strcmp(argv[i], "--overload-budget") == 0 && i + 1 < argc) {
+            robot.SetOverloadBudget(std::strtod(argv[++i], nullptr));
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--refine] [--overload-budget MS]" << std::endl;
+            return 1;
+        }
+    }
     robot.Run(true);  // Start the robot operation, with camera input disabled
     return 0;  // Return success
 }
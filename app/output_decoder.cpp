@@ -0,0 +1,81 @@
+/**
+ * @file output_decoder.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the selection of the YOLO output decoder matching a model.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include "../include/output_decoder.hpp"
+
+namespace {
+
+    /**
+    * @brief Selects the decoder instantiation of one layout.
+    *
+    * @tparam Layout The memory layout of the output.
+    * @param classes The number of class scores per candidate.
+    * @param person_only Whether only class 0 is decoded.
+    * @return The decoder matching the class count.
+    */
+    template <TrackAI::OutputLayout Layout>
+    TrackAI::DecodeFunction SelectForLayout(int classes, bool person_only) {
+        if (classes == 1) {
+            return &TrackAI::OutputDecoder<Layout, 1, true>::Decode;
+        }
+        if (classes == 80) {
+            return person_only
+                ? &TrackAI::OutputDecoder<Layout, 80, true>::Decode
+                : &TrackAI::OutputDecoder<Layout, 80, false>::Decode;
+        }
+        return person_only
+            ? &TrackAI::OutputDecoder<Layout, 0, true>::Decode
+            : &TrackAI::OutputDecoder<Layout, 0, false>::Decode;
+    }
+
+}  // namespace
+
+/**
+ * @brief Describes the output tensor of a YOLO model from its shape.
+ *
+ * @param output The first output tensor of the model.
+ * @param format Output receiving the layout, anchor and class counts.
+ * @return True if the shape is a supported YOLO output.
+ */
+bool TrackAI::DescribeOutput(const cv::Mat &output, OutputFormat *format) {
+    if (output.dims != 3 || output.size[0] != 1 || output.depth() != CV_32F ||
+        !output.isContinuous()) {
+        return false;
+    }
+
+    const int rows = output.size[1];
+    const int columns = output.size[2];
+    if (rows < columns) {
+        // Channel-major: box rows, then one row per class, anchors last.
+        format->layout = OutputLayout::YOLOV8;
+        format->anchors = columns;
+        format->classes = rows - 4;
+    } else {
+        // Anchor-major: box, objectness and class scores per anchor.
+        format->layout = OutputLayout::YOLOV5;
+        format->anchors = rows;
+        format->classes = columns - 5;
+    }
+    return format->classes > 0;
+}
+
+/**
+ * @brief Selects the decoder instantiation for an output format.
+ *
+ * @param format The format of the output.
+ * @param person_only Whether only class 0 is decoded.
+ * @return The decoder to call on every output of this format.
+ */
+TrackAI::DecodeFunction TrackAI::SelectDecoder(const OutputFormat &format,
+    bool person_only) {
+    if (format.layout == OutputLayout::YOLOV5) {
+        return SelectForLayout<OutputLayout::YOLOV5>(format.classes, person_only);
+    }
+    return SelectForLayout<OutputLayout::YOLOV8>(format.classes, person_only);
+}
@@ -0,0 +1,257 @@
+/**
+ * @file recorder.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the Recorder class, which encodes
+ *        frames in parallel and muxes them into segmented Motion-JPEG AVI files.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include "../include/recorder.hpp"
+
+/**
+ * @brief Constructs a Recorder.
+ *
+ * @param prefix Path prefix of the segments, "_NNN.avi" is appended.
+ * @param segment_seconds Duration of one segment in seconds.
+ * @param workers Number of encoder threads, 0 for one per core.
+ * @param max_backlog Largest number of frames waiting to be written.
+ */
+TrackAI::Recorder::Recorder(const std::string &prefix, double segment_seconds,
+    int workers, size_t max_backlog)
+    : prefix(prefix),
+      segment_seconds(segment_seconds),
+      worker_count(workers),
+      max_backlog(max_backlog),
+      started(false),
+      closing(false),
+      next_sequence(0),
+      next_to_write(0),
+      start_tick(0),
+      total_encode_ms(0.0),
+      segment_start(0.0),
+      segment_last(0.0) {
+    if (worker_count <= 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    stats = RecorderStats{0, 0, 0, 0, 0, 0, 0.0, 0.0, 0.0};
+}
+
+/**
+ * @brief Drains the backlog and finalizes the last segment.
+ */
+TrackAI::Recorder::~Recorder() {
+    Close();
+}
+
+/**
+ * @brief Queues a frame for recording, timestamped now.
+ *
+ * @param frame The frame to record. It is copied.
+ * @return False if the backlog was full and the frame was dropped.
+ */
+bool TrackAI::Recorder::Push(const cv::Mat &frame) {
+    double now = std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return Push(frame, now);
+}
+
+/**
+ * @brief Queues a frame for recording with an explicit timestamp.
+ *
+ * The threads are started with the first frame, whose size becomes the size
+ * of the recording; later frames of another size are resized by the encoders.
+ *
+ * @param frame The frame to record. It is copied.
+ * @param timestamp The capture time of the frame in seconds.
+ * @return False if the backlog was full and the frame was dropped.
+ */
+bool TrackAI::Recorder::Push(const cv::Mat &frame, double timestamp) {
+    if (frame.empty()) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started) {
+            frame_size = frame.size();
+            start_tick = cv::getTickCount();
+            started = true;
+            for (int i = 0; i < worker_count; ++i) {
+                encoders.push_back(std::thread(&Recorder::EncodeLoop, this));
+            }
+            muxer = std::thread(&Recorder::MuxLoop, this);
+        }
+        if (next_sequence - next_to_write >= max_backlog) {
+            stats.dropped++;
+            return false;
+        }
+    }
+
+    // Copy outside the lock so the encoders are not held up.
+    Job job;
+    job.image = frame.clone();
+    job.timestamp = timestamp;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    job.sequence = next_sequence++;
+    jobs.push_back(std::move(job));
+    stats.pushed++;
+    job_ready.notify_one();
+    return true;
+}
+
+/**
+ * @brief Writes every accepted frame and finalizes the last segment.
+ */
+void TrackAI::Recorder::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started) return;
+        closing = true;
+    }
+    job_ready.notify_all();
+    for (std::thread &encoder : encoders) {
+        encoder.join();
+    }
+    encoders.clear();
+
+    frame_encoded.notify_all();
+    muxer.join();
+    FinishSegment();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    started = false;
+    closing = false;
+}
+
+/**
+ * @brief Returns the throughput and backlog counters.
+ */
+TrackAI::RecorderStats TrackAI::Recorder::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    RecorderStats current = stats;
+    current.backlog = static_cast<size_t>(next_sequence - next_to_write);
+    if (current.encoded > 0) {
+        double elapsed_s = (cv::getTickCount() - start_tick)
+                           / cv::getTickFrequency();
+        current.encode_fps = elapsed_s > 0.0 ? current.encoded / elapsed_s : 0.0;
+        current.mean_encode_ms = total_encode_ms / current.encoded;
+    }
+    return current;
+}
+
+/**
+ * @brief Returns the paths of all segments written so far.
+ */
+std::vector<std::string> TrackAI::Recorder::Segments() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return segment_paths;
+}
+
+/**
+ * @brief Body of an encoder thread.
+ *
+ * Encodes queued frames to JPEG until the queue is empty and the recorder
+ * is closing.
+ */
+void TrackAI::Recorder::EncodeLoop() {
+    const std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, 90};
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        job_ready.wait(lock, [this] { return closing || !jobs.empty(); });
+        if (jobs.empty()) return;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        int64 start = cv::getTickCount();
+        if (job.image.size() != frame_size) {
+            cv::resize(job.image, job.image, frame_size);
+        }
+        Encoded result;
+        result.timestamp = job.timestamp;
+        cv::imencode(".jpg", job.image, result.jpeg, params);
+        double encode_ms = (cv::getTickCount() - start) * 1000.0
+                           / cv::getTickFrequency();
+
+        lock.lock();
+        encoded[job.sequence] = std::move(result);
+        stats.encoded++;
+        total_encode_ms += encode_ms;
+        frame_encoded.notify_one();
+    }
+}
+
+/**
+ * @brief Body of the muxer thread.
+ *
+ * Writes encoded frames strictly in sequence order, starting a new segment
+ * whenever the current one spans the segment duration.
+ */
+void TrackAI::Recorder::MuxLoop() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        frame_encoded.wait(lock, [this] {
+            return encoded.count(next_to_write) > 0 ||
+                   (closing && next_to_write == next_sequence);
+        });
+        auto next = encoded.find(next_to_write);
+        if (next == encoded.end()) return;
+
+        Encoded frame = std::move(next->second);
+        encoded.erase(next);
+        lock.unlock();
+
+        // Rotate to a new segment once the current one is full.
+        if (writer.IsOpen() && frame.timestamp - segment_start >= segment_seconds) {
+            FinishSegment();
+        }
+        if (!writer.IsOpen()) {
+            lock.lock();
+            std::string path = prefix + cv::format("_%03d.avi",
+                static_cast<int>(segment_paths.size()));
+            lock.unlock();
+            if (writer.Open(path, frame_size.width, frame_size.height)) {
+                segment_start = frame.timestamp;
+                lock.lock();
+                segment_paths.push_back(path);
+                stats.segments++;
+                lock.unlock();
+            } else {
+                std::cerr << "Error opening file " << path << std::endl;
+            }
+        }
+
+        bool written = writer.WriteFrame(frame.jpeg);
+        segment_last = frame.timestamp;
+
+        lock.lock();
+        next_to_write++;
+        if (written) {
+            stats.written++;
+        } else {
+            stats.dropped++;
+        }
+    }
+}
+
+/**
+ * @brief Finalizes the current segment with its measured frame rate.
+ */
+void TrackAI::Recorder::FinishSegment() {
+    if (!writer.IsOpen()) return;
+
+    uint32_t frames = writer.Frames();
+    double span = segment_last - segment_start;
+    double fps = (frames > 1 && span > 0.0) ? (frames - 1) / span : 5.0;
+    writer.Close(fps);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.segment_fps = fps;
+}
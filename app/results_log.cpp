@@ -0,0 +1,369 @@
+/**
+ * @file results_log.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the binary results log writer
+ *        and its memory-mapped reader.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include "../include/results_log.hpp"
+
+namespace {
+
+const char kLogMagic[8] = {'T', 'R', 'K', 'A', 'I', 'L', 'O', 'G'};
+const char kIndexMagic[8] = {'T', 'R', 'K', 'A', 'I', 'I', 'D', 'X'};
+const uint32_t kVersion = 1;
+const size_t kStreamBuffer = 1 << 16;   ///< stdio buffer size of each file
+
+/**
+ * @brief Builds the header of a log or index file.
+ *
+ * @param magic The eight magic bytes of the file.
+ * @param element_size The size of one record or index entry.
+ * @param header Receives kHeaderSize bytes.
+ */
+void MakeHeader(const char *magic, uint32_t element_size, char *header) {
+    std::memset(header, 0, TrackAI::ResultsLog::kHeaderSize);
+    std::memcpy(header, magic, 8);
+    std::memcpy(header + 8, &kVersion, sizeof(kVersion));
+    std::memcpy(header + 12, &element_size, sizeof(element_size));
+}
+
+/**
+ * @brief Checks the header of a log or index file.
+ *
+ * @param header At least kHeaderSize bytes read from the file.
+ * @param magic The expected magic bytes.
+ * @param element_size The expected element size.
+ * @return True if the header matches.
+ */
+bool CheckHeader(const char *header, const char *magic, uint32_t element_size) {
+    uint32_t version;
+    uint32_t size;
+    std::memcpy(&version, header + 8, sizeof(version));
+    std::memcpy(&size, header + 12, sizeof(size));
+    return std::memcmp(header, magic, 8) == 0 && version == kVersion &&
+           size == element_size;
+}
+
+/**
+ * @brief Opens an existing file for appending or creates it with a header.
+ *
+ * @param path The path of the file.
+ * @param magic The magic bytes of the file.
+ * @param element_size The size of one element of the file.
+ * @param count Receives the number of complete elements in the file.
+ * @return The open file, or null on failure.
+ */
+std::FILE *OpenAppend(const std::string &path, const char *magic,
+    uint32_t element_size, uint64_t *count) {
+    char header[TrackAI::ResultsLog::kHeaderSize];
+    std::FILE *file = std::fopen(path.c_str(), "r+b");
+    if (file) {
+        if (std::fread(header, 1, sizeof(header), file) != sizeof(header) ||
+            !CheckHeader(header, magic, element_size)) {
+            std::fclose(file);
+            return nullptr;
+        }
+        std::fseek(file, 0, SEEK_END);
+        *count = (std::ftell(file) - sizeof(header)) / element_size;
+    } else {
+        file = std::fopen(path.c_str(), "w+b");
+        if (!file) return nullptr;
+        MakeHeader(magic, element_size, header);
+        std::fwrite(header, 1, sizeof(header), file);
+        *count = 0;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, kStreamBuffer);
+    return file;
+}
+
+/**
+ * @brief Drops everything after the first elements of a file.
+ *
+ * @param file The file to truncate.
+ * @param element_size The size of one element of the file.
+ * @param count The number of elements to keep.
+ */
+void Truncate(std::FILE *file, uint32_t element_size, uint64_t count) {
+    std::fflush(file);
+    off_t size = TrackAI::ResultsLog::kHeaderSize + count * element_size;
+    if (ftruncate(fileno(file), size) == 0) {
+        std::fseek(file, size, SEEK_SET);
+    }
+}
+
+/**
+ * @brief Maps a whole file read-only and checks its header.
+ *
+ * @param path The path of the file.
+ * @param magic The expected magic bytes.
+ * @param element_size The expected element size.
+ * @param size Receives the size of the mapping.
+ * @return The mapping, or null on failure.
+ */
+void *MapFile(const std::string &path, const char *magic, uint32_t element_size,
+    size_t *size) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat info;
+    void *map = nullptr;
+    if (fstat(fd, &info) == 0 &&
+        static_cast<size_t>(info.st_size) >= TrackAI::ResultsLog::kHeaderSize) {
+        map = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            map = nullptr;
+        } else if (!CheckHeader(static_cast<const char *>(map), magic,
+                                element_size)) {
+            munmap(map, info.st_size);
+            map = nullptr;
+        } else {
+            *size = info.st_size;
+        }
+    }
+    ::close(fd);
+    return map;
+}
+
+}  // namespace
+
+/**
+ * @brief Returns the path of the index file of a log.
+ *
+ * @param path The path of the log.
+ * @return The path of the index file.
+ */
+std::string TrackAI::ResultsLog::IndexPath(const std::string &path) {
+    return path + ".idx";
+}
+
+/**
+ * @brief Constructs a closed ResultsLog.
+ */
+TrackAI::ResultsLog::ResultsLog()
+    : log_file(nullptr), index_file(nullptr), record_count(0), frame_count(0) {}
+
+/**
+ * @brief Flushes and closes the log.
+ */
+TrackAI::ResultsLog::~ResultsLog() {
+    Close();
+}
+
+/**
+ * @brief Opens a log for appending, creating it if needed.
+ *
+ * When an existing log is reopened, index entries pointing past the last
+ * complete record and records not covered by the index are discarded, so a
+ * log cut short by a crash is repaired to its last complete frame.
+ *
+ * @param path The path of the log; the index is written next to it.
+ * @return False if the files could not be opened or are not results logs.
+ */
+bool TrackAI::ResultsLog::Open(const std::string &path) {
+    Close();
+    log_file = OpenAppend(path, kLogMagic, sizeof(DetectionRecord),
+                          &record_count);
+    index_file = OpenAppend(IndexPath(path), kIndexMagic,
+                            sizeof(FrameIndexEntry), &frame_count);
+    if (!log_file || !index_file) {
+        Close();
+        return false;
+    }
+
+    // Keep only frames whose records are complete.
+    FrameIndexEntry entry = {0, 0, 0};
+    while (frame_count > 0) {
+        std::fseek(index_file, kHeaderSize + (frame_count - 1) * sizeof(entry),
+                   SEEK_SET);
+        if (std::fread(&entry, sizeof(entry), 1, index_file) == 1 &&
+            entry.first_record + entry.count <= record_count) {
+            break;
+        }
+        frame_count--;
+    }
+    uint64_t indexed = frame_count > 0 ? entry.first_record + entry.count : 0;
+    Truncate(index_file, sizeof(FrameIndexEntry), frame_count);
+    Truncate(log_file, sizeof(DetectionRecord), indexed);
+    record_count = indexed;
+    return true;
+}
+
+/**
+ * @brief Appends the records of one frame.
+ *
+ * @param frame_index The index of the frame.
+ * @param records The detections of the frame.
+ * @return False if the log is closed, the frame is out of order, or the
+ *         write failed.
+ */
+bool TrackAI::ResultsLog::Append(uint64_t frame_index,
+    const std::vector<DetectionRecord> &records) {
+    if (!log_file || frame_index < frame_count) return false;
+
+    // Skipped frames get empty entries so entry N always describes frame N.
+    FrameIndexEntry entry = {record_count, 0, 0};
+    while (frame_count < frame_index) {
+        std::fwrite(&entry, sizeof(entry), 1, index_file);
+        frame_count++;
+    }
+
+    if (!records.empty()) {
+        std::fwrite(records.data(), sizeof(DetectionRecord), records.size(),
+                    log_file);
+    }
+    entry.count = static_cast<uint32_t>(records.size());
+    std::fwrite(&entry, sizeof(entry), 1, index_file);
+
+    record_count += records.size();
+    frame_count++;
+    return !std::ferror(log_file) && !std::ferror(index_file);
+}
+
+/**
+ * @brief Pushes buffered records to the operating system.
+ *
+ * The records are flushed before the index, so after Flush the index only
+ * refers to written records. Between flushes either stream may reach the
+ * disk first; Open repairs a log cut short in between.
+ */
+void TrackAI::ResultsLog::Flush() {
+    if (log_file) std::fflush(log_file);
+    if (index_file) std::fflush(index_file);
+}
+
+/**
+ * @brief Flushes and closes the log.
+ */
+void TrackAI::ResultsLog::Close() {
+    Flush();
+    if (log_file) std::fclose(log_file);
+    if (index_file) std::fclose(index_file);
+    log_file = nullptr;
+    index_file = nullptr;
+}
+
+/**
+ * @brief Returns whether the log is open.
+ */
+bool TrackAI::ResultsLog::IsOpen() const {
+    return log_file != nullptr;
+}
+
+/**
+ * @brief Returns the index of the next frame to append.
+ */
+uint64_t TrackAI::ResultsLog::NextFrame() const {
+    return frame_count;
+}
+
+/**
+ * @brief Constructs a closed reader.
+ */
+TrackAI::ResultsLogReader::ResultsLogReader()
+    : log_map(nullptr), log_size(0), index_map(nullptr), index_size(0),
+      records(nullptr), entries(nullptr), record_count(0), frame_count(0) {}
+
+/**
+ * @brief Unmaps the log.
+ */
+TrackAI::ResultsLogReader::~ResultsLogReader() {
+    Close();
+}
+
+/**
+ * @brief Maps a log and its index.
+ *
+ * Trailing partial records or entries, as left by a writer that is still
+ * running or crashed, are ignored.
+ *
+ * @param path The path of the log.
+ * @return False if the files could not be mapped or are not results logs.
+ */
+bool TrackAI::ResultsLogReader::Open(const std::string &path) {
+    Close();
+    log_map = MapFile(path, kLogMagic, sizeof(DetectionRecord), &log_size);
+    index_map = MapFile(ResultsLog::IndexPath(path), kIndexMagic,
+                        sizeof(FrameIndexEntry), &index_size);
+    if (!log_map || !index_map) {
+        Close();
+        return false;
+    }
+
+    const size_t header = ResultsLog::kHeaderSize;
+    records = reinterpret_cast<const DetectionRecord *>(
+        static_cast<const char *>(log_map) + header);
+    entries = reinterpret_cast<const FrameIndexEntry *>(
+        static_cast<const char *>(index_map) + header);
+    record_count = (log_size - header) / sizeof(DetectionRecord);
+    frame_count = (index_size - header) / sizeof(FrameIndexEntry);
+    while (frame_count > 0 &&
+           entries[frame_count - 1].first_record +
+           entries[frame_count - 1].count > record_count) {
+        frame_count--;
+    }
+    return true;
+}
+
+/**
+ * @brief Unmaps the log.
+ */
+void TrackAI::ResultsLogReader::Close() {
+    if (log_map) munmap(log_map, log_size);
+    if (index_map) munmap(index_map, index_size);
+    log_map = nullptr;
+    index_map = nullptr;
+    records = nullptr;
+    entries = nullptr;
+    record_count = 0;
+    frame_count = 0;
+}
+
+/**
+ * @brief Returns the number of records in the log.
+ */
+uint64_t TrackAI::ResultsLogReader::Records() const {
+    return record_count;
+}
+
+/**
+ * @brief Returns the number of indexed frames.
+ */
+uint64_t TrackAI::ResultsLogReader::Frames() const {
+    return frame_count;
+}
+
+/**
+ * @brief Returns a record by position.
+ *
+ * @param position The position of the record, below Records().
+ */
+const TrackAI::DetectionRecord &TrackAI::ResultsLogReader::Record(
+    uint64_t position) const {
+    return records[position];
+}
+
+/**
+ * @brief Finds the records of a frame in constant time.
+ *
+ * @param frame_index The index of the frame.
+ * @param count Receives the number of records of the frame.
+ * @return The first record of the frame, or null if the frame has none.
+ */
+const TrackAI::DetectionRecord *TrackAI::ResultsLogReader::Frame(
+    uint64_t frame_index, uint32_t *count) const {
+    *count = 0;
+    if (frame_index >= frame_count) return nullptr;
+
+    const FrameIndexEntry &entry = entries[frame_index];
+    *count = entry.count;
+    return entry.count > 0 ? records + entry.first_record : nullptr;
+}
@@ -9,6 +9,9 @@
  * @copyright Copyright (c) 2024
  */
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include "robot.hpp"
 
 /**
@@ -21,7 +24,10 @@ TrackAI::Robot::Robot()
                                    0, 600.0, 240.0,
                                    0, 0, 1.0)),
       R(cv::Mat::eye(3, 3, CV_64F)),
-      T((cv::Mat_<double>(3, 1) << 0, 0, 2.0)) {
+      T((cv::Mat_<double>(3, 1) << 0, 0, 2.0)),
+      frame_index(0),
+      refine(false),
+      cascade_enabled(false) {
     // Default camera intrinsic matrix K
     // Default rotation matrix R (identity matrix, no rotation)
     // Default translation vector T (2 units along the Z-axis)
@@ -37,7 +43,8 @@ TrackAI::Robot::Robot()
  * @param my_T The translation vector.
  */
 TrackAI::Robot::Robot(cv::Mat my_K, cv::Mat my_R, cv::Mat my_T)
-    : K(my_K), R(my_R), T(my_T) {}
+    : K(my_K), R(my_R), T(my_T), frame_index(0), refine(false),
+      cascade_enabled(false) {}
 
 /**
  * @brief Runs the detection and tracking process.
@@ -53,29 +60,122 @@ void TrackAI::Robot::Run(bool is_camera) {
     std::vector<cv::Mat> detections;
     cv::Mat human;
     std::string model_path = "Data/Model/yolov8s.onnx";
-    net = detector.Load(model_path);  // Load the YOLO model
+    net = detector.Load(model_path, true, true);  // Load the YOLO model, person head only
 
-    if (is_camera) {
-        cv::VideoCapture cap(0);  // Open the default camera
+    // Record every detection; frame indices continue an existing log
+    if (results_log.Open("Results/detections.tlog")) {
+        frame_index = results_log.NextFrame();
+    } else {
+        std::cerr << "Warning: Could not open the results log." << std::endl;
+    }
 
-        // Check if the camera is successfully opened
-        if (!cap.isOpened()) {
+    // Share the annotated frames and detections with other local processes
+    if (!publisher.Open("/trackai")) {
+        std::cerr << "Warning: Could not create the shared-memory ring." << std::endl;
+    }
+
+    if (is_camera) {
+        // Capture on a dedicated thread that always keeps the freshest frame
+        TrackAI::FrameGrabber grabber;
+        if (!grabber.Open(0)) {
             std::cerr << "Error: Could not access the camera." << std::endl;
             return;
         }
 
-        while (true) {
-            cv::Mat frame;
-            cap >> frame;  // Capture a frame from the camera
+        TrackAI::StampedFrame frame;
+        TrackAI::StampedFrame next_frame;
+        if (refine || cascade_enabled) {
+            // Each frame depends on the tracks or the latency of the previous
+            // one, so detection cannot run ahead of tracking.
+            while (grabber.Next(&frame)) {
+                ProcessImage(frame.image, detections, human,
+                             LatencyMonitor::Begin(frame.sequence, frame.captured));
+                double age_ms = grabber.ReportResult(frame);
+                std::cout << "Frame " << frame.sequence << " result age: "
+                          << age_ms << " ms" << std::endl;
+
+                // Exit on ESC key press
+                if (cv::waitKey(25) == 27) break;
+            }
+
+            TrackAI::RefinerStats refiner_stats = refiner.Stats();
+            std::cout << "Refinement: " << refiner_stats.refined << "/"
+                      << refiner_stats.frames << " frames from "
+                      << refiner_stats.crops << " crops, "
+                      << refiner_stats.fallbacks << " fallbacks, "
+                      << 100.0 * refiner_stats.compute_saved
+                      << "% compute saved" << std::endl;
+
+            TrackAI::CascadeStats cascade_stats = cascade.Stats();
+            std::cout << "Detection: " << cascade_stats.dnn_frames << " DNN, "
+                      << cascade_stats.verify_frames << " HOG+DNN, "
+                      << cascade_stats.hog_frames << " HOG frames, "
+                      << cascade_stats.switches << " switches" << std::endl;
+        } else {
+            if (!grabber.Next(&frame)) {
+                std::cerr << "Error: Could not read from the camera." << std::endl;
+                return;
+            }
+            FrameStamps stamps = LatencyMonitor::Begin(frame.sequence, frame.captured);
+            FrameStamps next_stamps;
+            stamps.started = std::chrono::steady_clock::now();
+            uint64 ticket = detector.Submit(frame.image);
+
+            while (true) {
+                detections = detector.Wait(ticket, &stamps.inferred);
+
+                // Overlap inference of the freshest frame with postprocessing
+                bool has_next = grabber.Next(&next_frame);
+                if (has_next) {
+                    next_stamps = LatencyMonitor::Begin(next_frame.sequence,
+                                                        next_frame.captured);
+                    next_stamps.started = std::chrono::steady_clock::now();
+                    ticket = detector.Submit(next_frame.image);
+                }
+
+                ProcessDetections(frame.image, detections, human, stamps);
+                double age_ms = grabber.ReportResult(frame);
+                std::cout << "Frame " << frame.sequence << " result age: "
+                          << age_ms << " ms" << std::endl;
 
-           ProcessImage(frame, detections, human);
+                if (!has_next) break;
+                frame = next_frame;
+                stamps = next_stamps;
 
-            // Exit on ESC key press
-            if (cv::waitKey(25) == 27) {
-                break;  // Break the loop if ESC is pressed
+                // Exit on ESC key press
+                if (cv::waitKey(25) == 27) {
+                    detector.Wait(ticket);  // Drain the frame still in flight
+                    break;  // Break the loop if ESC is pressed
+                }
             }
         }
-        cap.release();  // Release the camera
+        grabber.Close();  // Release the camera
+
+        TrackAI::AsyncStats stats = detector.Stats();
+        std::cout << "Inference: " << stats.completed << " frames, mean latency "
+                  << stats.mean_latency_ms << " ms, max in flight "
+                  << stats.max_in_flight << std::endl;
+
+        TrackAI::GrabberStats capture_stats = grabber.Stats();
+        std::cout << "Capture: " << capture_stats.captured << " frames, "
+                  << capture_stats.dropped << " dropped, "
+                  << capture_stats.reallocated << " outside the pool, mean age "
+                  << capture_stats.mean_age_ms << " ms, max age "
+                  << capture_stats.max_age_ms << " ms" << std::endl;
+
+        TrackAI::PoolStats pool_stats = grabber.PoolUsage();
+        std::cout << "Frame pool: " << pool_stats.peak_in_use << "/"
+                  << pool_stats.capacity << " buffers at peak, "
+                  << pool_stats.acquired << " acquired, "
+                  << pool_stats.dropped << " dropped" << std::endl;
+
+        TrackAI::LatencySummary age = latency.Summary();
+        std::cout << "Result age over the last " << age.window << " frames: p50 "
+                  << age.p50_ms << " ms, p90 " << age.p90_ms << " ms, p99 "
+                  << age.p99_ms << " ms, max " << age.max_ms << " ms (wait "
+                  << age.wait_ms << ", inference " << age.inference_ms
+                  << ", decode " << age.decode_ms << ", track "
+                  << age.track_ms << " ms on average)" << std::endl;
     } else {
         std::string folder_path = "Data/Images/";
         std::vector<std::string> image_files = {"img0.jpg", "img1.jpg",
@@ -91,15 +191,128 @@ void TrackAI::Robot::Run(bool is_camera) {
         }
     }
     visualizer.SaveResults();  // Save the results
+    results_log.Close();  // Flush the remaining records
+    publisher.Close();  // Unlink the shared-memory ring
     cv::destroyAllWindows();  // Close all OpenCV windows
 }
 
+/**
+ * @brief Loads the detection model without starting the main loop.
+ *
+ * A missing model file is reported through the return value, so callers such as
+ * the benchmarks can fall back to injecting detections through ProcessDetections.
+ *
+ * @param model_path The path to the ONNX model file.
+ * @return True if the model was loaded, false if the file does not exist.
+ * @throws std::runtime_error If the file exists but the model fails to load.
+ */
+bool TrackAI::Robot::LoadModel(const std::string &model_path) {
+    if (!std::ifstream(model_path).good()) return false;
+
+    std::string path = model_path;
+    net = detector.Load(path, true, true);  // Only people are tracked
+    return true;
+}
+
+/**
+ * @brief Disables the display window and the video recording.
+ *
+ * @param headless True to run without any window or recording.
+ */
+void TrackAI::Robot::SetHeadless(bool headless) {
+    visualizer.headless = headless;
+}
+
+/**
+ * @brief Enables detecting the tracked people from crops around them.
+ *
+ * @param enabled True to refine the tracked boxes from crops.
+ */
+void TrackAI::Robot::SetRefinement(bool enabled) {
+    refine = enabled;
+}
+
+/**
+ * @brief Returns the counters of the region refinement.
+ */
+TrackAI::RefinerStats TrackAI::Robot::RefinementStats() const {
+    return refiner.Stats();
+}
+
+/**
+ * @brief Enables falling back to HOG-based detection under overload.
+ *
+ * @param budget_ms The frame latency budget in milliseconds, zero to always
+ *                  detect with the DNN.
+ */
+void TrackAI::Robot::SetOverloadBudget(double budget_ms) {
+    cascade_enabled = budget_ms > 0.0;
+    cascade.SetBudget(budget_ms);
+    if (!cascade_enabled) {
+        cascade.SetMode(CascadeMode::DNN);
+    }
+}
+
+/**
+ * @brief Returns the counters of the detector cascade.
+ */
+TrackAI::CascadeStats TrackAI::Robot::OverloadStats() const {
+    return cascade.Stats();
+}
+
 /**
  * @brief Processes an input image for detection and tracking.
  *
  * This method takes a frame, runs detection on it, and creates bounding boxes
  * around detected objects. It also tracks the detected humans and visualizes 
- * the results.
+ * the results. With refinement enabled, the people tracked in the previous
+ * frames are searched for in crops around their boxes, predicted to the
+ * capture time of this frame from their velocity.
+ *
+ * @param frame The input image to process.
+ * @param detections A vector to store the detection results.
+ * @param human A matrix to hold the detected human information.
+ * @param stamps The timestamps of the frame, from its capture on.
+ */
+void TrackAI::Robot::ProcessImage(
+    cv::Mat &frame, std::vector<cv::Mat> &detections, cv::Mat &human,
+    FrameStamps stamps) {
+    bool cheaper = cascade_enabled && cascade.Mode() != CascadeMode::DNN;
+    stamps.started = std::chrono::steady_clock::now();
+    if (!refine && !cheaper) {
+        detections = detector.PreProcess(frame, net);
+        stamps.inferred = std::chrono::steady_clock::now();
+        ProcessDetections(frame, detections, human, stamps);
+    } else {
+        std::vector<int> class_ids;
+        std::vector<float> confidences;
+        std::vector<cv::Rect> boxes;
+        std::vector<int> indices;
+        detections.clear();
+        if (cheaper) {
+            cascade.Detect(detector, net, frame, &class_ids, &confidences,
+                           &boxes, &indices);
+        } else {
+            track_store.PredictedBoxes(Seconds(stamps.captured), &predicted);
+            refiner.Detect(detector, net, frame, predicted, &class_ids,
+                           &confidences, &boxes, &indices);
+        }
+        // Both detect and decode in one call
+        stamps.inferred = stamps.decoded = std::chrono::steady_clock::now();
+        human = frame;
+        ProcessBoxes(frame, class_ids, confidences, boxes, indices, human,
+                     &stamps);
+    }
+
+    // Pick the detection mode of the next frame from the age of this result
+    if (cascade_enabled) {
+        cascade.ReportLatency(LatencyMonitor::Ms(
+            stamps.captured, std::chrono::steady_clock::now()));
+    }
+}
+
+/**
+ * @brief Processes a single image that did not come from the camera.
  *
  * @param frame The input image to process.
  * @param detections A vector to store the detection results.
@@ -107,8 +320,25 @@ void TrackAI::Robot::Run(bool is_camera) {
  */
 void TrackAI::Robot::ProcessImage(
     cv::Mat &frame, std::vector<cv::Mat> &detections, cv::Mat &human) {
-    detections = detector.PreProcess(frame, net);
+    ProcessImage(frame, detections, human, LatencyMonitor::Begin(
+        frame_index, std::chrono::steady_clock::now()));
+}
 
+/**
+ * @brief Postprocesses, tracks and displays the raw detections of a frame.
+ *
+ * This method extracts the bounding boxes from the raw network outputs,
+ * tracks the detected humans, visualizes the results and prints their
+ * coordinates in the robot frame.
+ *
+ * @param frame The image frame the detections belong to.
+ * @param detections The raw network outputs of the frame.
+ * @param human A matrix to hold the detected human information.
+ * @param stamps The timestamps of the frame, up to inferred.
+ */
+void TrackAI::Robot::ProcessDetections(
+    cv::Mat &frame, std::vector<cv::Mat> &detections, cv::Mat &human,
+    FrameStamps stamps) {
     std::vector<int> class_ids;
     std::vector<float> confidences;
     std::vector<cv::Rect> boxes;
@@ -116,6 +346,52 @@ void TrackAI::Robot::ProcessImage(
 
     human = detector.PostProcess(frame, detections, &class_ids,
      &confidences, &boxes, &indices);
+    stamps.decoded = std::chrono::steady_clock::now();
+    ProcessBoxes(frame, class_ids, confidences, boxes, indices, human, &stamps);
+}
+
+/**
+ * @brief Postprocesses the raw detections of a frame that did not come from the camera.
+ *
+ * @param frame The image frame the detections belong to.
+ * @param detections The raw network outputs of the frame.
+ * @param human A matrix to hold the detected human information.
+ */
+void TrackAI::Robot::ProcessDetections(
+    cv::Mat &frame, std::vector<cv::Mat> &detections, cv::Mat &human) {
+    ProcessDetections(frame, detections, human, LatencyMonitor::Begin(
+        frame_index, std::chrono::steady_clock::now()));
+}
+
+/**
+ * @brief Returns the capture-to-result age percentiles of the recent frames.
+ */
+TrackAI::LatencySummary TrackAI::Robot::Latency() const {
+    return latency.Summary();
+}
+
+/**
+ * @brief Tracks, displays, logs and publishes the detections of a frame.
+ *
+ * @param frame The image frame the detections belong to.
+ * @param class_ids The class of every candidate.
+ * @param confidences The confidence of every candidate.
+ * @param boxes The box of every candidate in the frame.
+ * @param indices The candidates kept by non-maximum suppression.
+ * @param human A matrix to hold the detected human information.
+ * @param stamps The timestamps of the frame, up to decoded. Receives the
+ *               emitted stamp.
+ */
+void TrackAI::Robot::ProcessBoxes(cv::Mat &frame,
+    const std::vector<int> &class_ids, const std::vector<float> &confidences,
+    const std::vector<cv::Rect> &boxes, const std::vector<int> &indices,
+    cv::Mat &human, FrameStamps *stamps) {
+    // Describe the appearance of every person before the boxes are drawn
+    std::vector<float> signatures(indices.size() * TrackStore::kSignatureSize);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        TrackStore::ComputeSignature(frame, boxes[indices[i]],
+                                     &signatures[i * TrackStore::kSignatureSize]);
+    }
 
     std::vector<cv::Rect> bboxes;
     visualizer.CreateBoundingBox(indices, boxes, &bboxes, frame,
@@ -123,46 +399,132 @@ void TrackAI::Robot::ProcessImage(
 
     std::cout << "Number of detections: " << bboxes.size() << std::endl;
 
-    TrackAI::Tracker tracker;
     tracker.Track(human, bboxes);
-    visualizer.DisplayResults(net, human);
+    visualizer.DisplayResults(detector.InferenceMs(), human,
+                              Seconds(stamps->captured));
 
     // Transform and print coordinates in robot frame
-    CoorInRobotFrame(bboxes);
+    std::vector<cv::Point3d> positions;
+    CoorInRobotFrame(bboxes, &positions);
+    stamps->emitted = std::chrono::steady_clock::now();
+    latency.Add(*stamps);
+
+    // Give every person a stable identifier across frames
+    std::vector<int> track_ids;
+    std::vector<int> released;
+    track_store.Update(Seconds(stamps->captured), bboxes,
+                       signatures.empty() ? nullptr : signatures.data(),
+                       &track_ids, &released);
+
+    // Estimate the motion of every person, stamped with the capture time
+    std::vector<Eigen::Vector3d> measured;
+    for (const cv::Point3d &position : positions) {
+        measured.push_back(Eigen::Vector3d(position.x, position.y, position.z));
+    }
+    for (int id : released) {
+        predictor.Remove(id);  // The identifier may go to someone else next
+    }
+    predictor.UpdateTracked(Seconds(stamps->captured), measured, track_ids);
+
+    // Log the detections of this frame and publish them with the frame
+    if (results_log.IsOpen() || publisher.IsOpen()) {
+        int64_t timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            stamps->captured.time_since_epoch()).count();
+        std::vector<TrackAI::DetectionRecord> records(bboxes.size());
+        for (size_t i = 0; i < bboxes.size(); ++i) {
+            TrackAI::DetectionRecord &record = records[i];
+            record.frame_index = frame_index;
+            record.timestamp_ns = timestamp_ns;
+            record.x = bboxes[i].x;
+            record.y = bboxes[i].y;
+            record.width = bboxes[i].width;
+            record.height = bboxes[i].height;
+            record.confidence = confidences[indices[i]];
+            record.class_id = class_ids[indices[i]];
+            record.track_id = track_ids[i];
+            record.robot_x = static_cast<float>(positions[i].x);
+            record.robot_y = static_cast<float>(positions[i].y);
+            record.robot_z = static_cast<float>(positions[i].z);
+            LatencyMonitor::Encode(*stamps, &record);
+        }
+        if (results_log.IsOpen()) {
+            results_log.Append(frame_index, records);
+        }
+        if (publisher.IsOpen()) {
+            publisher.Publish(frame_index, timestamp_ns, human, records);
+        }
+    }
+    frame_index++;
+}
+
+/**
+ * @brief Predicts the position of every tracked person at a given time.
+ *
+ * @param when The time to predict at.
+ * @param targets Output receiving the predicted state of every track.
+ */
+void TrackAI::Robot::PredictTargets(std::chrono::steady_clock::time_point when,
+    std::vector<PredictedTarget> *targets) const {
+    predictor.PredictAll(Seconds(when), targets);
+}
+
+/**
+ * @brief Converts a steady clock time into the seconds used by the predictor.
+ *
+ * @param time The time point to convert.
+ * @return The time in seconds since the steady clock epoch.
+ */
+double TrackAI::Robot::Seconds(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration<double>(time.time_since_epoch()).count();
 }
 
 /**
  * @brief Transforms detected bounding box coordinates into the robot's coordinate frame.
  *
- * This method calculates the center of each detected bounding box and converts it
- * from normalized camera coordinates to the robot frame coordinates.
+ * The center of every box is back-projected through the inverse intrinsic
+ * matrix into a viewing ray. A single camera gives no depth, so the depth
+ * along the ray is estimated by assuming the box spans an upright person of
+ * kPersonHeight metres: Z = fy * kPersonHeight / box height. The camera frame
+ * point is then mapped into the robot frame with R and T, giving metres.
+ * Boxes cut by the frame border or by occlusion look shorter, so they are
+ * placed too far away.
  *
  * @param detections A vector of bounding boxes representing detected objects.
+ * @param positions Optional output receiving the robot frame coordinates of every box.
  */
-void TrackAI::Robot::CoorInRobotFrame(const std::vector<cv::Rect> &detections) {
+void TrackAI::Robot::CoorInRobotFrame(const std::vector<cv::Rect> &detections,
+    std::vector<cv::Point3d> *positions) {
+    if (positions) positions->clear();
+
     // Check if detections are empty
     if (detections.empty()) return;
 
+    const cv::Mat K_inv = K.inv();
+    const double fy = K.at<double>(1, 1);
+
     // Loop through each detected object
     for (const cv::Rect &bbox : detections) {
         // Calculate the center of the bounding box
         cv::Point2f center(bbox.x + bbox.width / 2.0,
         bbox.y + bbox.height / 2.0);
 
-        // Create a 3D point in normalized camera coordinates
-        cv::Mat normalized_point = (cv::Mat_<double>(3, 1) << center.x,
-                                    center.y, 1.0);
+        // Back-project the pixel into a ray with unit depth
+        cv::Mat pixel = (cv::Mat_<double>(3, 1) << center.x, center.y, 1.0);
+        cv::Mat ray = K_inv * pixel;
+
+        // Place the point at the depth where the box is a person tall
+        double depth = fy * kPersonHeight / std::max(bbox.height, 1);
+        cv::Mat camera_frame_point = ray * depth;
 
-        // Convert from normalized camera coordinates to camera frame
-        cv::Mat camera_frame_point = R * normalized_point + T;
+        // Convert from the camera frame to the robot frame
+        cv::Mat robot_frame_point = R * camera_frame_point + T;
 
-        // Extract the X, Y, Z coordinates in the camera frame or robot frame
-        // You can store multiple coordinates if needed
-        double x = camera_frame_point.at<double>(0, 0);
-        double y = camera_frame_point.at<double>(1, 0);
-        double z = camera_frame_point.at<double>(2, 0);
+        double x = robot_frame_point.at<double>(0, 0);
+        double y = robot_frame_point.at<double>(1, 0);
+        double z = robot_frame_point.at<double>(2, 0);
 
         std::cout << "Object coordinates in robot frame: X=" << x << ", Y="
                   << y << ", Z=" << z << std::endl;
+        if (positions) positions->push_back(cv::Point3d(x, y, z));
     }
 }
@@ -0,0 +1,149 @@
+/**
+ * @file roi_refiner.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the RoiRefiner class, which refreshes
+ *        tracked boxes from a batch of low-resolution crops.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include <iostream>
+#include "../include/roi_refiner.hpp"
+
+/**
+ * @brief Constructs a refiner.
+ *
+ * @param full_interval A full-frame pass runs at least every this many frames.
+ * @param padding Context added on every side of a box, relative to its size.
+ * @param region_input Network input size of a crop, a multiple of 32.
+ * @param max_regions Largest number of crops run instead of the full frame.
+ */
+TrackAI::RoiRefiner::RoiRefiner(int full_interval, float padding,
+    cv::Size region_input, size_t max_regions)
+    : full_interval(full_interval),
+      padding(padding),
+      region_input(region_input),
+      max_regions(max_regions),
+      supported(true),
+      since_full(0),
+      input_pixels(0.0),
+      stats{0, 0, 0, 0, 0, 0.0} {}
+
+/**
+ * @brief Detects the people of a frame, refining the tracked boxes when possible.
+ *
+ * Compute is estimated from the network input pixels, which the cost of the
+ * convolutional forward pass is proportional to. A fallback frame pays for
+ * both its crops and the full-frame pass.
+ *
+ * @param detector The detector, loaded with the model.
+ * @param net The network returned by Detector::Load.
+ * @param frame The frame to detect in.
+ * @param tracks The boxes of the tracked people, predicted for this frame.
+ * @param class_ids A pointer to a vector to store detected class IDs.
+ * @param confidences A pointer to a vector to store confidence scores.
+ * @param boxes A pointer to a vector to store bounding boxes.
+ * @param indices A pointer to a vector to store indices of the filtered detections.
+ * @return True if the frame was detected from crops alone.
+ */
+bool TrackAI::RoiRefiner::Detect(Detector &detector, cv::dnn::Net &net,
+    cv::Mat &frame, const std::vector<cv::Rect> &tracks,
+    std::vector<int> *class_ids, std::vector<float> *confidences,
+    std::vector<cv::Rect> *boxes, std::vector<int> *indices) {
+    const double full_pixels = static_cast<double>(kFullInput) * kFullInput;
+    stats.frames++;
+    since_full++;
+
+    bool scheduled = !supported || tracks.empty() || since_full >= full_interval;
+    if (!scheduled) {
+        PlanRegions(tracks, frame.size(), padding, &regions);
+        if (!regions.empty() && regions.size() <= max_regions) {
+            class_ids->clear();
+            confidences->clear();
+            boxes->clear();
+            indices->clear();
+            try {
+                std::vector<cv::Mat> outputs =
+                    detector.PreProcessRegions(frame, regions, region_input, net);
+                detector.PostProcessRegions(outputs, regions, region_input,
+                                            class_ids, confidences, boxes, indices);
+                stats.crops += regions.size();
+                input_pixels += regions.size() *
+                    static_cast<double>(region_input.area());
+            } catch (const std::exception &e) {
+                // Fixed-shape models reject other input or batch sizes.
+                supported = false;
+                indices->clear();
+                std::cerr << "Warning: The model does not accept crop batches ("
+                          << e.what() << "), region refinement disabled."
+                          << std::endl;
+            }
+
+            // Every tracked person must be found again, or someone left the
+            // crops and the whole frame has to be searched.
+            if (supported && indices->size() >= tracks.size()) {
+                stats.refined++;
+                stats.compute_saved = 1.0 - input_pixels / (stats.frames * full_pixels);
+                return true;
+            }
+        }
+        stats.fallbacks++;
+    }
+
+    class_ids->clear();
+    confidences->clear();
+    boxes->clear();
+    indices->clear();
+    std::vector<cv::Mat> outputs = detector.PreProcess(frame, net);
+    detector.PostProcess(frame, outputs, class_ids, confidences, boxes, indices);
+    stats.full_passes++;
+    since_full = 0;
+    input_pixels += full_pixels;
+    stats.compute_saved = 1.0 - input_pixels / (stats.frames * full_pixels);
+    return false;
+}
+
+/**
+ * @brief Returns the counters of the refiner.
+ */
+TrackAI::RefinerStats TrackAI::RoiRefiner::Stats() const {
+    return stats;
+}
+
+/**
+ * @brief Computes the crops covering a set of boxes.
+ *
+ * @param tracks The boxes to cover.
+ * @param frame_size The size of the frame.
+ * @param padding Context added on every side of a box, relative to its size.
+ * @param regions Output receiving the crops.
+ */
+void TrackAI::RoiRefiner::PlanRegions(const std::vector<cv::Rect> &tracks,
+    cv::Size frame_size, float padding, std::vector<cv::Rect> *regions) {
+    const cv::Rect frame_rect(cv::Point(0, 0), frame_size);
+    regions->clear();
+    for (const cv::Rect &track : tracks) {
+        const int side = static_cast<int>(
+            std::max(track.width, track.height) * (1.0f + 2.0f * padding));
+        const cv::Point center(track.x + track.width / 2,
+                               track.y + track.height / 2);
+        cv::Rect region = cv::Rect(center.x - side / 2, center.y - side / 2,
+                                   side, side) & frame_rect;
+        if (region.area() <= 0) continue;
+
+        bool merged = false;
+        for (cv::Rect &existing : *regions) {
+            const int overlap = (region & existing).area();
+            if (overlap > std::min(region.area(), existing.area()) / 2) {
+                existing |= region;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            regions->push_back(region);
+        }
+    }
+}
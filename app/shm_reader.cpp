@@ -0,0 +1,88 @@
+/**
+ * @file shm_reader.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the command line tool that follows the frames and
+ *        detections published in shared memory by a running trackAI.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * Usage: trackAI-shm-reader [name] [--count N] [--latest]
+ */
+
+#include <unistd.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "../include/shm_ring.hpp"
+
+/**
+ * @brief Prints the frames and detections of a shared-memory ring as they arrive.
+ *
+ * @param argc Argument count from the command line.
+ * @param argv Argument vector: the segment name, optionally --count N and --latest.
+ * @return int Returns 0 on success and 1 if the segment could not be opened.
+ */
+int main(int argc, char** argv) {
+    std::string name = "/trackai";
+    uint64_t count = 0;  // 0: follow until the publisher goes away
+    bool latest = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--latest") == 0) {
+            latest = true;
+        } else {
+            name = argv[i];
+        }
+    }
+
+    TrackAI::ShmSubscriber subscriber;
+    if (!subscriber.Open(name)) {
+        std::fprintf(stderr, "Could not open shared memory %s\n", name.c_str());
+        return 1;
+    }
+
+    uint64_t received = 0;
+    uint64_t torn = 0;
+    int idle_ms = 0;
+    TrackAI::ShmFrame frame;
+    while (count == 0 || received < count) {
+        bool has_frame = latest ? subscriber.Latest(&frame)
+                                : subscriber.Next(&frame);
+        if (!has_frame) {
+            // Give up after five seconds without a frame
+            if (idle_ms >= 5000) break;
+            usleep(1000);
+            idle_ms++;
+            continue;
+        }
+        idle_ms = 0;
+
+        // Summarize in place, then make sure the slot was not overwritten
+        std::string summary;
+        char line[128];
+        for (uint32_t i = 0; i < frame.count; ++i) {
+            const TrackAI::DetectionRecord &record = frame.records[i];
+            std::snprintf(line, sizeof(line), " [track %d: %.2f %.2f %.2f]",
+                          record.track_id, record.robot_x, record.robot_y,
+                          record.robot_z);
+            summary += line;
+        }
+        if (!subscriber.Valid(frame)) {
+            torn++;
+            continue;
+        }
+        received++;
+        std::printf("seq %" PRIu64 " frame %" PRIu64 " %dx%d, %u detections%s\n",
+                    frame.sequence, frame.frame_index, frame.image.cols,
+                    frame.image.rows, frame.count, summary.c_str());
+    }
+
+    std::printf("%" PRIu64 " frames read, %" PRIu64 " dropped, %" PRIu64
+                " overwritten while read\n", received, subscriber.Dropped(),
+                torn);
+    return 0;
+}
@@ -0,0 +1,448 @@
+/**
+ * @file shm_ring.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the shared-memory frame publisher and
+ *        subscriber, a lock-free ring buffer guarded by per-slot sequence locks.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include "../include/shm_ring.hpp"
+
+namespace {
+
+    const char kMagic[8] = {'T', 'R', 'K', 'A', 'I', 'S', 'H', 'M'};
+    const uint32_t kVersion = 1;
+    const size_t kAlignment = 64;  ///< Cache line; every block starts on one
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+                  "Shared-memory counters must be lock-free");
+
+    /**
+    * @struct RingHeader
+    * @brief First 64 bytes of the segment.
+    */
+    struct RingHeader {
+        char magic[8];                    ///< "TRKAISHM", written last on creation
+        uint32_t version;                 ///< Format version
+        uint32_t slot_count;              ///< Number of slots
+        uint64_t slot_bytes;              ///< Size of a slot including its header
+        uint64_t max_image_bytes;         ///< Room for the image in every slot
+        uint32_t max_detections;          ///< Room for records in every slot
+        uint32_t reserved;                ///< Padding, zero
+        std::atomic<uint64_t> head;       ///< Sequence number of the newest complete frame
+        uint64_t padding[2];              ///< Pads the header to 64 bytes
+    };
+    static_assert(sizeof(RingHeader) == 64, "RingHeader must be 64 bytes");
+
+    /**
+    * @struct SlotHeader
+    * @brief First 64 bytes of a slot, followed by the records and the image.
+    */
+    struct SlotHeader {
+        std::atomic<uint64_t> lock;   ///< Odd while written, 2 * sequence when complete
+        uint64_t sequence;            ///< Sequence number of the frame
+        uint64_t frame_index;         ///< Index of the frame in the pipeline
+        int64_t timestamp_ns;         ///< Capture time in nanoseconds
+        int32_t rows;                 ///< Image height
+        int32_t cols;                 ///< Image width
+        int32_t type;                 ///< OpenCV type of the image
+        uint32_t count;               ///< Number of detection records
+        uint64_t image_bytes;         ///< Size of the image data
+        uint64_t padding;             ///< Pads the header to 64 bytes
+    };
+    static_assert(sizeof(SlotHeader) == 64, "SlotHeader must be 64 bytes");
+
+    /**
+    * @brief Rounds a size up to the alignment.
+    */
+    size_t Aligned(size_t bytes) {
+        return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    /**
+    * @brief Returns the slot holding a sequence number.
+    */
+    SlotHeader *SlotOf(const unsigned char *base, uint64_t sequence) {
+        const RingHeader *header = reinterpret_cast<const RingHeader *>(base);
+        size_t offset = sizeof(RingHeader) +
+                        (sequence % header->slot_count) * header->slot_bytes;
+        return reinterpret_cast<SlotHeader *>(
+            const_cast<unsigned char *>(base) + offset);
+    }
+
+}  // namespace
+
+/**
+ * @brief Constructs a closed publisher.
+ */
+TrackAI::ShmPublisher::ShmPublisher()
+    : base(nullptr), mapped_bytes(0), sequence(0), rejected(0) {}
+
+/**
+ * @brief Closes the publisher and unlinks its segment.
+ */
+TrackAI::ShmPublisher::~ShmPublisher() {
+    Close();
+}
+
+/**
+ * @brief Creates the shared-memory segment.
+ *
+ * A stale segment of the same name is unlinked first, so readers still
+ * mapping it keep the old data instead of seeing it change under them.
+ * The magic is written last, so readers never attach to a partly
+ * initialized segment.
+ *
+ * @param segment_name Name of the POSIX shared-memory object.
+ * @param slot_count Number of frames kept in the ring.
+ * @param max_image_bytes Largest image size in bytes.
+ * @param max_detections Largest number of detection records per frame.
+ * @return True if the segment was created and mapped.
+ */
+bool TrackAI::ShmPublisher::Open(const std::string &segment_name,
+    uint32_t slot_count, size_t max_image_bytes, uint32_t max_detections) {
+    Close();
+    if (slot_count == 0) return false;
+
+    const size_t slot_bytes = sizeof(SlotHeader) +
+        Aligned(max_detections * sizeof(DetectionRecord)) +
+        Aligned(max_image_bytes);
+    const size_t total = sizeof(RingHeader) + slot_count * slot_bytes;
+
+    shm_unlink(segment_name.c_str());
+    int fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        close(fd);
+        shm_unlink(segment_name.c_str());
+        return false;
+    }
+    void *memory = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(segment_name.c_str());
+        return false;
+    }
+
+    // The segment is zero-filled: every slot lock is 0, i.e. empty.
+    RingHeader *header = static_cast<RingHeader *>(memory);
+    header->version = kVersion;
+    header->slot_count = slot_count;
+    header->slot_bytes = slot_bytes;
+    header->max_image_bytes = max_image_bytes;
+    header->max_detections = max_detections;
+    header->head.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kMagic, sizeof(kMagic));
+
+    name = segment_name;
+    base = static_cast<unsigned char *>(memory);
+    mapped_bytes = total;
+    sequence = 0;
+    rejected = 0;
+    return true;
+}
+
+/**
+ * @brief Unmaps and unlinks the segment.
+ */
+void TrackAI::ShmPublisher::Close() {
+    if (!base) return;
+    munmap(base, mapped_bytes);
+    shm_unlink(name.c_str());
+    base = nullptr;
+    mapped_bytes = 0;
+}
+
+/**
+ * @brief Returns whether the segment is open.
+ */
+bool TrackAI::ShmPublisher::IsOpen() const {
+    return base != nullptr;
+}
+
+/**
+ * @brief Publishes a frame and its detection records.
+ *
+ * The slot lock is made odd before the slot is written and set to twice the
+ * sequence number once it is complete; the ring head is advanced last.
+ *
+ * @param frame_index Index of the frame in the pipeline.
+ * @param timestamp_ns Capture time on the steady clock in nanoseconds.
+ * @param image The image to publish.
+ * @param records The detection records of the frame.
+ * @return False if the publisher is closed or the frame does not fit.
+ */
+bool TrackAI::ShmPublisher::Publish(uint64_t frame_index, int64_t timestamp_ns,
+    const cv::Mat &image, const std::vector<DetectionRecord> &records) {
+    if (!base) return false;
+    RingHeader *header = reinterpret_cast<RingHeader *>(base);
+    const size_t row_bytes = image.cols * image.elemSize();
+    const size_t image_bytes = row_bytes * image.rows;
+    if (image.dims > 2 || image_bytes > header->max_image_bytes ||
+        records.size() > header->max_detections) {
+        rejected++;
+        return false;
+    }
+
+    const uint64_t next = sequence + 1;
+    SlotHeader *slot = SlotOf(base, next);
+    slot->lock.store(2 * next - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->sequence = next;
+    slot->frame_index = frame_index;
+    slot->timestamp_ns = timestamp_ns;
+    slot->rows = image.rows;
+    slot->cols = image.cols;
+    slot->type = image.type();
+    slot->count = static_cast<uint32_t>(records.size());
+    slot->image_bytes = image_bytes;
+
+    unsigned char *data = reinterpret_cast<unsigned char *>(slot + 1);
+    if (!records.empty()) {
+        std::memcpy(data, records.data(),
+                    records.size() * sizeof(DetectionRecord));
+    }
+    unsigned char *pixels = data +
+        Aligned(header->max_detections * sizeof(DetectionRecord));
+    if (image.isContinuous()) {
+        std::memcpy(pixels, image.data, image_bytes);
+    } else {
+        for (int r = 0; r < image.rows; ++r) {
+            std::memcpy(pixels + r * row_bytes, image.ptr(r), row_bytes);
+        }
+    }
+
+    slot->lock.store(2 * next, std::memory_order_release);
+    header->head.store(next, std::memory_order_release);
+    sequence = next;
+    return true;
+}
+
+/**
+ * @brief Returns the sequence number of the last published frame.
+ */
+uint64_t TrackAI::ShmPublisher::Sequence() const {
+    return sequence;
+}
+
+/**
+ * @brief Returns the number of frames that did not fit into a slot.
+ */
+uint64_t TrackAI::ShmPublisher::Rejected() const {
+    return rejected;
+}
+
+/**
+ * @brief Constructs a closed subscriber.
+ */
+TrackAI::ShmSubscriber::ShmSubscriber()
+    : base(nullptr), mapped_bytes(0), next_sequence(1), dropped(0) {}
+
+/**
+ * @brief Unmaps the segment.
+ */
+TrackAI::ShmSubscriber::~ShmSubscriber() {
+    Close();
+}
+
+/**
+ * @brief Maps an existing segment for reading.
+ *
+ * @param segment_name Name of the POSIX shared-memory object.
+ * @return True if the segment exists and has the expected format.
+ */
+bool TrackAI::ShmSubscriber::Open(const std::string &segment_name) {
+    Close();
+    int fd = shm_open(segment_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        static_cast<size_t>(info.st_size) < sizeof(RingHeader)) {
+        close(fd);
+        return false;
+    }
+    void *memory = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return false;
+
+    const RingHeader *header = static_cast<const RingHeader *>(memory);
+    bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && header->version == kVersion && header->slot_count > 0 &&
+            sizeof(RingHeader) + header->slot_count * header->slot_bytes <=
+            static_cast<size_t>(info.st_size);
+    if (!valid) {
+        munmap(memory, info.st_size);
+        return false;
+    }
+
+    base = static_cast<const unsigned char *>(memory);
+    mapped_bytes = info.st_size;
+    dropped = 0;
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    next_sequence = head > 0 ? head : 1;
+    return true;
+}
+
+/**
+ * @brief Unmaps the segment.
+ */
+void TrackAI::ShmSubscriber::Close() {
+    if (!base) return;
+    munmap(const_cast<unsigned char *>(base), mapped_bytes);
+    base = nullptr;
+    mapped_bytes = 0;
+}
+
+/**
+ * @brief Returns whether a segment is mapped.
+ */
+bool TrackAI::ShmSubscriber::IsOpen() const {
+    return base != nullptr;
+}
+
+/**
+ * @brief Returns the next unread frame, in sequence order.
+ *
+ * @param frame Output receiving a view of the frame.
+ * @return False if no new frame has been published.
+ */
+bool TrackAI::ShmSubscriber::Next(ShmFrame *frame) {
+    if (!base) return false;
+    const RingHeader *header = reinterpret_cast<const RingHeader *>(base);
+
+    while (true) {
+        uint64_t head = header->head.load(std::memory_order_acquire);
+        if (head < next_sequence) return false;  // Nothing new
+
+        // Skip the frames the publisher has already overwritten.
+        uint64_t oldest = head >= header->slot_count
+                          ? head - header->slot_count + 1 : 1;
+        if (next_sequence < oldest) {
+            dropped += oldest - next_sequence;
+            next_sequence = oldest;
+        }
+
+        if (ReadSlot(next_sequence, frame)) {
+            next_sequence++;
+            return true;
+        }
+        // Overwritten while we looked: the head has moved on, try again.
+    }
+}
+
+/**
+ * @brief Returns the newest frame, skipping any unread ones.
+ *
+ * @param frame Output receiving a view of the frame.
+ * @return False if no new frame has been published.
+ */
+bool TrackAI::ShmSubscriber::Latest(ShmFrame *frame) {
+    if (!base) return false;
+    const RingHeader *header = reinterpret_cast<const RingHeader *>(base);
+
+    while (true) {
+        uint64_t head = header->head.load(std::memory_order_acquire);
+        if (head < next_sequence) return false;
+        if (ReadSlot(head, frame)) {
+            dropped += head - next_sequence;
+            next_sequence = head + 1;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Returns whether a frame view has not been overwritten.
+ *
+ * @param frame A view returned by Next or Latest.
+ */
+bool TrackAI::ShmSubscriber::Valid(const ShmFrame &frame) const {
+    if (!base || !frame.slot) return false;
+    const SlotHeader *slot = static_cast<const SlotHeader *>(frame.slot);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->lock.load(std::memory_order_relaxed) == 2 * frame.sequence;
+}
+
+/**
+ * @brief Copies a frame out of the ring buffer.
+ *
+ * @param frame A view returned by Next or Latest.
+ * @param image Output receiving a copy of the image.
+ * @param records Output receiving a copy of the detection records.
+ * @return False if the frame was overwritten during the copy.
+ */
+bool TrackAI::ShmSubscriber::Copy(const ShmFrame &frame, cv::Mat *image,
+    std::vector<DetectionRecord> *records) const {
+    if (image) frame.image.copyTo(*image);
+    if (records) records->assign(frame.records, frame.records + frame.count);
+    return Valid(frame);
+}
+
+/**
+ * @brief Returns the number of frames overwritten before they were read.
+ */
+uint64_t TrackAI::ShmSubscriber::Dropped() const {
+    return dropped;
+}
+
+/**
+ * @brief Returns the sequence number of the newest published frame.
+ */
+uint64_t TrackAI::ShmSubscriber::Head() const {
+    if (!base) return 0;
+    return reinterpret_cast<const RingHeader *>(base)->head.load(
+        std::memory_order_acquire);
+}
+
+/**
+ * @brief Reads the frame with a sequence number into a view.
+ *
+ * The slot header is read under the slot lock; the image and records are
+ * returned in place and must be checked with Valid after use.
+ *
+ * @param sequence The sequence number of the frame.
+ * @param frame Output receiving a view of the frame.
+ * @return False if the slot no longer, or not yet, holds that frame.
+ */
+bool TrackAI::ShmSubscriber::ReadSlot(uint64_t sequence, ShmFrame *frame) const {
+    const RingHeader *header = reinterpret_cast<const RingHeader *>(base);
+    const SlotHeader *slot = SlotOf(base, sequence);
+    if (slot->lock.load(std::memory_order_acquire) != 2 * sequence) {
+        return false;
+    }
+
+    SlotHeader copy;
+    std::memcpy(static_cast<void *>(&copy), slot, sizeof(SlotHeader));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->lock.load(std::memory_order_relaxed) != 2 * sequence ||
+        copy.image_bytes > header->max_image_bytes ||
+        copy.count > header->max_detections) {
+        return false;
+    }
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(slot + 1);
+    const unsigned char *pixels = data +
+        Aligned(header->max_detections * sizeof(DetectionRecord));
+    frame->sequence = sequence;
+    frame->frame_index = copy.frame_index;
+    frame->timestamp_ns = copy.timestamp_ns;
+    frame->image = cv::Mat(copy.rows, copy.cols, copy.type,
+                           const_cast<unsigned char *>(pixels));
+    frame->records = reinterpret_cast<const DetectionRecord *>(data);
+    frame->count = copy.count;
+    frame->slot = slot;
+    return true;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file target_predictor.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the TargetPredictor class, which estimates
+ *        and predicts the 3D position and velocity of every tracked person.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include "../include/target_predictor.hpp"
+
+/**
+ * @brief Constructs a predictor.
+ *
+ * @param acceleration_noise Standard deviation of the unmodelled acceleration in m/s^2.
+ * @param measurement_noise Standard deviation of a measured position in m.
+ * @param gate Largest distance between a track and its measurement in m.
+ * @param max_misses Updates without a measurement before a track is dropped.
+ */
+TrackAI::TargetPredictor::TargetPredictor(double acceleration_noise,
+    double measurement_noise, double gate, int max_misses)
+    : acceleration_noise(acceleration_noise),
+      measurement_noise(measurement_noise),
+      gate(gate),
+      max_misses(max_misses),
+      next_id(0) {}
+
+/**
+ * @brief Feeds the positions measured in one frame.
+ *
+ * Every track is propagated to the frame time, then the closest
+ * track/measurement pairs within the gate are matched greedily. Matched
+ * tracks are corrected, unmatched measurements start new tracks, and
+ * unmatched tracks that missed too many frames are dropped.
+ *
+ * @param timestamp Capture time of the frame in seconds.
+ * @param positions Positions of the detected people in the robot frame.
+ * @param ids Optional output receiving the track of every position.
+ */
+void TrackAI::TargetPredictor::Update(double timestamp,
+    const std::vector<Eigen::Vector3d> &positions, std::vector<int> *ids) {
+    for (TargetTrack &track : tracks) {
+        Propagate(&track, timestamp);
+    }
+
+    // Candidate pairs within the gate, closest first.
+    candidates.clear();
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        const Eigen::Vector3d predicted = tracks[t].state.head<3>();
+        for (size_t m = 0; m < positions.size(); ++m) {
+            double distance = (positions[m] - predicted).norm();
+            if (distance <= gate) {
+                candidates.push_back(std::make_pair(
+                    distance, static_cast<int>(t * positions.size() + m)));
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    track_match.assign(tracks.size(), -1);
+    measurement_match.assign(positions.size(), -1);
+    for (const std::pair<double, int> &candidate : candidates) {
+        int t = candidate.second / static_cast<int>(positions.size());
+        int m = candidate.second % static_cast<int>(positions.size());
+        if (track_match[t] < 0 && measurement_match[m] < 0) {
+            track_match[t] = m;
+            measurement_match[m] = t;
+        }
+    }
+
+    // Correct the matched tracks and age the others.
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        if (track_match[t] >= 0) {
+            Correct(&tracks[t], positions[track_match[t]]);
+            tracks[t].misses = 0;
+        } else {
+            tracks[t].misses++;
+        }
+    }
+
+    if (ids) ids->assign(positions.size(), -1);
+    for (size_t m = 0; m < positions.size(); ++m) {
+        if (measurement_match[m] >= 0) {
+            if (ids) (*ids)[m] = tracks[measurement_match[m]].id;
+            continue;
+        }
+
+        // Start a new track at rest, with a wide velocity uncertainty.
+        TargetTrack track;
+        track.id = next_id++;
+        track.stamp = timestamp;
+        track.misses = 0;
+        track.state << positions[m], Eigen::Vector3d::Zero();
+        track.covariance.setZero();
+        track.covariance.topLeftCorner<3, 3>().diagonal().setConstant(
+            measurement_noise * measurement_noise);
+        track.covariance.bottomRightCorner<3, 3>().diagonal().setConstant(
+            4.0);  // (2 m/s)^2, a brisk walk in any direction
+        tracks.push_back(track);
+        if (ids) (*ids)[m] = track.id;
+    }
+
+    // Drop the tracks that have been missing for too long.
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(),
+        [this](const TargetTrack &track) {
+            return track.misses > max_misses;
+        }), tracks.end());
+}
+
+/**
+ * @brief Feeds the positions measured in one frame, already associated.
+ *
+ * The identifiers come from an image tracker that hands out small integers,
+ * so the track of every identifier is found through a table indexed by it.
+ *
+ * @param timestamp Capture time of the frame in seconds.
+ * @param positions Positions of the detected people in the robot frame.
+ * @param ids The non-negative track identifier of every position.
+ */
+void TrackAI::TargetPredictor::UpdateTracked(double timestamp,
+    const std::vector<Eigen::Vector3d> &positions, const std::vector<int> &ids) {
+    int max_id = -1;
+    for (TargetTrack &track : tracks) {
+        Propagate(&track, timestamp);
+        track.misses++;
+        max_id = std::max(max_id, track.id);
+    }
+    for (int id : ids) {
+        max_id = std::max(max_id, id);
+    }
+    track_of_id.assign(max_id + 1, -1);
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        track_of_id[tracks[t].id] = static_cast<int>(t);
+    }
+
+    for (size_t m = 0; m < positions.size() && m < ids.size(); ++m) {
+        if (ids[m] < 0) continue;
+        const int t = track_of_id[ids[m]];
+        if (t >= 0) {
+            Correct(&tracks[t], positions[m]);
+            tracks[t].misses = 0;
+            continue;
+        }
+
+        TargetTrack track;
+        track.id = ids[m];
+        track.stamp = timestamp;
+        track.misses = 0;
+        track.state << positions[m], Eigen::Vector3d::Zero();
+        track.covariance.setZero();
+        track.covariance.topLeftCorner<3, 3>().diagonal().setConstant(
+            measurement_noise * measurement_noise);
+        track.covariance.bottomRightCorner<3, 3>().diagonal().setConstant(4.0);
+        track_of_id[ids[m]] = static_cast<int>(tracks.size());
+        tracks.push_back(track);
+    }
+
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(),
+        [this](const TargetTrack &track) {
+            return track.misses > max_misses;
+        }), tracks.end());
+}
+
+/**
+ * @brief Drops one track, e.g. when its identifier is released.
+ *
+ * @param id Identifier of the track.
+ * @return False if there is no track with this identifier.
+ */
+bool TrackAI::TargetPredictor::Remove(int id) {
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        if (tracks[t].id == id) {
+            tracks.erase(tracks.begin() + t);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Predicts the state of every track at a given time.
+ *
+ * Under the constant-velocity model the predicted position is the estimated
+ * position moved by the velocity over the time since the last update.
+ *
+ * @param timestamp The time to predict at in seconds.
+ * @param targets Output receiving one prediction per track.
+ */
+void TrackAI::TargetPredictor::PredictAll(double timestamp,
+    std::vector<PredictedTarget> *targets) const {
+    targets->resize(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        const TargetTrack &track = tracks[i];
+        const double dt = timestamp - track.stamp;
+        PredictedTarget &target = (*targets)[i];
+        target.id = track.id;
+        target.velocity = track.state.tail<3>();
+        target.position = track.state.head<3>() + dt * target.velocity;
+    }
+}
+
+/**
+ * @brief Predicts the position of one track at a given time.
+ *
+ * @param id Identifier of the track.
+ * @param timestamp The time to predict at in seconds.
+ * @param position Output receiving the predicted position.
+ * @return False if there is no track with this identifier.
+ */
+bool TrackAI::TargetPredictor::Predict(int id, double timestamp,
+    Eigen::Vector3d *position) const {
+    for (const TargetTrack &track : tracks) {
+        if (track.id == id) {
+            *position = track.state.head<3>() +
+                        (timestamp - track.stamp) * track.state.tail<3>();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the number of tracks.
+ */
+size_t TrackAI::TargetPredictor::Size() const {
+    return tracks.size();
+}
+
+/**
+ * @brief Drops every track.
+ */
+void TrackAI::TargetPredictor::Clear() {
+    tracks.clear();
+}
+
+/**
+ * @brief Propagates a track to a later time.
+ *
+ * Uses the constant-velocity transition and the process noise of a white
+ * acceleration with the configured standard deviation.
+ *
+ * @param track The track to propagate.
+ * @param timestamp The time to propagate to in seconds.
+ */
+void TrackAI::TargetPredictor::Propagate(TargetTrack *track,
+    double timestamp) const {
+    const double dt = timestamp - track->stamp;
+    if (dt <= 0.0) return;
+
+    TargetTrack::Covariance transition = TargetTrack::Covariance::Identity();
+    transition.topRightCorner<3, 3>().diagonal().setConstant(dt);
+
+    const double q = acceleration_noise * acceleration_noise;
+    const double dt2 = dt * dt;
+    TargetTrack::Covariance noise = TargetTrack::Covariance::Zero();
+    noise.topLeftCorner<3, 3>().diagonal().setConstant(q * dt2 * dt2 / 4.0);
+    noise.topRightCorner<3, 3>().diagonal().setConstant(q * dt2 * dt / 2.0);
+    noise.bottomLeftCorner<3, 3>().diagonal().setConstant(q * dt2 * dt / 2.0);
+    noise.bottomRightCorner<3, 3>().diagonal().setConstant(q * dt2);
+
+    track->state = transition * track->state;
+    track->covariance = transition * track->covariance * transition.transpose()
+                        + noise;
+    track->stamp = timestamp;
+}
+
+/**
+ * @brief Corrects a propagated track with a measured position.
+ *
+ * @param track The track, already propagated to the measurement time.
+ * @param measurement The measured position in the robot frame.
+ */
+void TrackAI::TargetPredictor::Correct(TargetTrack *track,
+    const Eigen::Vector3d &measurement) const {
+    // Only the position is observed: H = [I 0].
+    const Eigen::Matrix3d innovation_covariance =
+        track->covariance.topLeftCorner<3, 3>() +
+        Eigen::Matrix3d::Identity() * (measurement_noise * measurement_noise);
+    const Eigen::Matrix<double, 6, 3> gain =
+        track->covariance.leftCols<3>() * innovation_covariance.inverse();
+
+    track->state += gain * (measurement - track->state.head<3>());
+    track->covariance -= gain * track->covariance.topRows<3>();
+}
@@ -0,0 +1,470 @@
+/**
+ * @file track_store.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the TrackStore class, the struct-of-arrays
+ *        table of tracked people.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <opencv2/imgproc.hpp>
+#include "../include/track_store.hpp"
+
+namespace {
+
+    const float kSignatureWeight = 0.2f;   ///< Weight of the newest signature in a track's average
+    const int kMinSaturation = 40;         ///< Saturation below which a pixel's hue is noise
+    const int kMaxGridCells = 1 << 16;     ///< Largest number of cells of the association grid
+
+    /**
+     * @brief Intersection over union of two center-size boxes.
+     */
+    inline float Overlap(float acx, float acy, float aw, float ah,
+                         float bcx, float bcy, float bw, float bh) {
+        const float ix = std::min(acx + aw / 2, bcx + bw / 2) -
+                         std::max(acx - aw / 2, bcx - bw / 2);
+        const float iy = std::min(acy + ah / 2, bcy + bh / 2) -
+                         std::max(acy - ah / 2, bcy - bh / 2);
+        if (ix <= 0.0f || iy <= 0.0f) return 0.0f;
+        const float inter = ix * iy;
+        return inter / (aw * ah + bw * bh - inter);
+    }
+
+    /**
+     * @brief Histogram intersection of two normalized signatures.
+     */
+    inline float Similarity(const float *a, const float *b) {
+        float sum = 0.0f;
+        for (int k = 0; k < TrackAI::TrackStore::kSignatureSize; ++k) {
+            sum += std::min(a[k], b[k]);
+        }
+        return sum;
+    }
+
+}  // namespace
+
+/**
+ * @brief Constructs an empty store.
+ *
+ * @param min_iou Smallest overlap of a predicted track and its detection.
+ * @param appearance_weight Weight of the appearance in the association score.
+ * @param max_misses Frames without a detection before a track is removed.
+ * @param velocity_gain Share of the position innovation applied to the velocity.
+ */
+TrackAI::TrackStore::TrackStore(float min_iou, float appearance_weight,
+    int max_misses, float velocity_gain)
+    : min_iou(min_iou),
+      appearance_weight(appearance_weight),
+      velocity_gain(velocity_gain),
+      max_misses(max_misses),
+      stamp(-1.0) {}
+
+/**
+ * @brief Tracks the detections of one frame.
+ *
+ * @param timestamp Capture time of the frame in seconds.
+ * @param detections The boxes detected in the frame.
+ * @param detection_signatures kSignatureSize floats per detection, or nullptr.
+ * @param detection_ids Output receiving the track identifier of every detection.
+ * @param removed Optional output receiving the identifiers released in this frame.
+ */
+void TrackAI::TrackStore::Update(double timestamp,
+    const std::vector<cv::Rect> &detections, const float *detection_signatures,
+    std::vector<int> *detection_ids, std::vector<int> *removed) {
+    const float dt = stamp >= 0.0 && timestamp > stamp
+                     ? static_cast<float>(timestamp - stamp) : 0.0f;
+    stamp = timestamp;
+    if (removed) removed->clear();
+
+    Predict(dt);
+    Age();
+    Associate(detections, detection_signatures, &detection_match);
+
+    detection_ids->assign(detections.size(), -1);
+    for (size_t j = 0; j < detections.size(); ++j) {
+        const cv::Rect &box = detections[j];
+        const float *signature = detection_signatures
+            ? detection_signatures + j * kSignatureSize : nullptr;
+        const int slot = detection_match[j];
+        if (slot < 0) {
+            (*detection_ids)[j] = Insert(box, signature);
+            continue;
+        }
+
+        // Alpha-beta correction: the position follows the detection, the
+        // velocity a share of the prediction error.
+        const float mx = box.x + box.width * 0.5f;
+        const float my = box.y + box.height * 0.5f;
+        if (dt > 0.0f) {
+            vx[slot] += velocity_gain * (mx - cx[slot]) / dt;
+            vy[slot] += velocity_gain * (my - cy[slot]) / dt;
+        }
+        cx[slot] = mx;
+        cy[slot] = my;
+        width[slot] = static_cast<float>(box.width);
+        height[slot] = static_cast<float>(box.height);
+        misses[slot] = 0;
+        if (signature) {
+            float *average = &signatures[slot * kSignatureSize];
+            for (int k = 0; k < kSignatureSize; ++k) {
+                average[k] += kSignatureWeight * (signature[k] - average[k]);
+            }
+        }
+        (*detection_ids)[j] = ids[slot];
+    }
+
+    Prune(removed);
+}
+
+/**
+ * @brief Moves every track along its velocity.
+ *
+ * @param dt The time step in seconds.
+ */
+void TrackAI::TrackStore::Predict(float dt) {
+    const size_t n = ids.size();
+    float *x = cx.data();
+    float *y = cy.data();
+    const float *u = vx.data();
+    const float *v = vy.data();
+    for (size_t i = 0; i < n; ++i) {
+        x[i] += u[i] * dt;
+        y[i] += v[i] * dt;
+    }
+}
+
+/**
+ * @brief Ages every track by one frame.
+ */
+void TrackAI::TrackStore::Age() {
+    const size_t n = ids.size();
+    int *a = age.data();
+    int *m = misses.data();
+    for (size_t i = 0; i < n; ++i) {
+        a[i] += 1;
+        m[i] += 1;
+    }
+}
+
+/**
+ * @brief Removes the tracks missing for more than max_misses frames.
+ *
+ * Walking the slots backwards keeps the swap-remove from moving a track
+ * that has not been checked yet.
+ *
+ * @param removed Optional output receiving the released identifiers.
+ */
+void TrackAI::TrackStore::Prune(std::vector<int> *removed) {
+    for (int slot = static_cast<int>(ids.size()) - 1; slot >= 0; --slot) {
+        if (misses[slot] > max_misses) {
+            if (removed) removed->push_back(ids[slot]);
+            Remove(ids[slot]);
+        }
+    }
+}
+
+/**
+ * @brief Matches detections with tracks through the spatial grid.
+ *
+ * The cell size is the largest box dimension, so the centers of two
+ * overlapping boxes are at most one cell apart in each direction and the
+ * 3 x 3 cells around a detection hold every track it can overlap. The
+ * tracks are bucketed by a counting sort, which costs O(tracks + cells).
+ *
+ * @param detections The boxes detected in the frame.
+ * @param detection_signatures kSignatureSize floats per detection, or nullptr.
+ * @param matches Output receiving the slot matched to every detection, or -1.
+ */
+void TrackAI::TrackStore::Associate(const std::vector<cv::Rect> &detections,
+    const float *detection_signatures, std::vector<int> *matches) {
+    const int n = static_cast<int>(ids.size());
+    const int m = static_cast<int>(detections.size());
+    matches->assign(m, -1);
+    if (n == 0 || m == 0) return;
+
+    float cell = 1.0f;
+    float min_x = cx[0], max_x = cx[0], min_y = cy[0], max_y = cy[0];
+    for (int i = 0; i < n; ++i) {
+        cell = std::max(cell, std::max(width[i], height[i]));
+        min_x = std::min(min_x, cx[i]);
+        max_x = std::max(max_x, cx[i]);
+        min_y = std::min(min_y, cy[i]);
+        max_y = std::max(max_y, cy[i]);
+    }
+    for (const cv::Rect &box : detections) {
+        cell = std::max(cell, static_cast<float>(std::max(box.width, box.height)));
+    }
+    int cols = static_cast<int>((max_x - min_x) / cell) + 1;
+    int rows = static_cast<int>((max_y - min_y) / cell) + 1;
+    while (static_cast<long>(cols) * rows > kMaxGridCells) {
+        cell *= 2.0f;  // Tracks spread far apart: coarser cells, same guarantee
+        cols = static_cast<int>((max_x - min_x) / cell) + 1;
+        rows = static_cast<int>((max_y - min_y) / cell) + 1;
+    }
+
+    cell_start.assign(cols * rows + 1, 0);
+    cell_of.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const int col = static_cast<int>((cx[i] - min_x) / cell);
+        const int row = static_cast<int>((cy[i] - min_y) / cell);
+        cell_of[i] = row * cols + col;
+        cell_start[cell_of[i] + 1]++;
+    }
+    for (int c = 0; c < cols * rows; ++c) {
+        cell_start[c + 1] += cell_start[c];
+    }
+    cell_items.resize(n);
+    track_match.assign(cell_start.begin(), cell_start.end() - 1);  // Fill cursors
+    for (int i = 0; i < n; ++i) {
+        cell_items[track_match[cell_of[i]]++] = i;
+    }
+
+    candidates.clear();
+    for (int j = 0; j < m; ++j) {
+        const cv::Rect &box = detections[j];
+        const float bw = static_cast<float>(box.width);
+        const float bh = static_cast<float>(box.height);
+        const float bx = box.x + bw * 0.5f;
+        const float by = box.y + bh * 0.5f;
+        const int col = static_cast<int>(std::floor((bx - min_x) / cell));
+        const int row = static_cast<int>(std::floor((by - min_y) / cell));
+        const float *signature = detection_signatures
+            ? detection_signatures + j * kSignatureSize : nullptr;
+
+        for (int r = std::max(row - 1, 0); r <= std::min(row + 1, rows - 1); ++r) {
+            for (int c = std::max(col - 1, 0); c <= std::min(col + 1, cols - 1); ++c) {
+                const int cell_index = r * cols + c;
+                for (int k = cell_start[cell_index]; k < cell_start[cell_index + 1]; ++k) {
+                    const int i = cell_items[k];
+                    const float iou = Overlap(cx[i], cy[i], width[i], height[i],
+                                              bx, by, bw, bh);
+                    if (iou < min_iou) continue;
+                    float score = iou;
+                    if (signature) {
+                        score = (1.0f - appearance_weight) * iou + appearance_weight *
+                            Similarity(&signatures[i * kSignatureSize], signature);
+                    }
+                    candidates.emplace_back(score, i * m + j);
+                }
+            }
+        }
+    }
+
+    // Greedy assignment, best pairs first.
+    std::sort(candidates.begin(), candidates.end(),
+              std::greater<std::pair<float, int>>());
+    track_match.assign(n, -1);
+    for (const auto &candidate : candidates) {
+        const int i = candidate.second / m;
+        const int j = candidate.second % m;
+        if (track_match[i] >= 0 || (*matches)[j] >= 0) continue;
+        track_match[i] = j;
+        (*matches)[j] = i;
+    }
+}
+
+/**
+ * @brief Starts a track.
+ *
+ * @param box The box of the track.
+ * @param signature kSignatureSize floats, or nullptr for a flat signature.
+ * @return The identifier of the new track.
+ */
+int TrackAI::TrackStore::Insert(const cv::Rect &box, const float *signature) {
+    int id;
+    if (!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = static_cast<int>(slot_of.size());
+        slot_of.push_back(-1);
+    }
+    slot_of[id] = static_cast<int>(ids.size());
+
+    cx.push_back(box.x + box.width * 0.5f);
+    cy.push_back(box.y + box.height * 0.5f);
+    width.push_back(static_cast<float>(box.width));
+    height.push_back(static_cast<float>(box.height));
+    vx.push_back(0.0f);
+    vy.push_back(0.0f);
+    age.push_back(0);
+    misses.push_back(0);
+    ids.push_back(id);
+    if (signature) {
+        signatures.insert(signatures.end(), signature, signature + kSignatureSize);
+    } else {
+        signatures.insert(signatures.end(), kSignatureSize, 1.0f / kSignatureSize);
+    }
+    return id;
+}
+
+/**
+ * @brief Removes a track.
+ *
+ * The last slot moves into the freed one, so every column stays packed.
+ *
+ * @param id The identifier of the track.
+ * @return False if there is no track with this identifier.
+ */
+bool TrackAI::TrackStore::Remove(int id) {
+    if (id < 0 || id >= static_cast<int>(slot_of.size()) || slot_of[id] < 0) {
+        return false;
+    }
+    const int slot = slot_of[id];
+    const int last = static_cast<int>(ids.size()) - 1;
+    if (slot != last) {
+        MoveSlot(last, slot);
+    }
+
+    cx.pop_back();
+    cy.pop_back();
+    width.pop_back();
+    height.pop_back();
+    vx.pop_back();
+    vy.pop_back();
+    age.pop_back();
+    misses.pop_back();
+    ids.pop_back();
+    signatures.resize(signatures.size() - kSignatureSize);
+
+    slot_of[id] = -1;
+    free_ids.push_back(id);
+    return true;
+}
+
+/**
+ * @brief Moves the slot of a track to another slot, overwriting it.
+ */
+void TrackAI::TrackStore::MoveSlot(int from, int to) {
+    cx[to] = cx[from];
+    cy[to] = cy[from];
+    width[to] = width[from];
+    height[to] = height[from];
+    vx[to] = vx[from];
+    vy[to] = vy[from];
+    age[to] = age[from];
+    misses[to] = misses[from];
+    ids[to] = ids[from];
+    std::copy(signatures.begin() + from * kSignatureSize,
+              signatures.begin() + (from + 1) * kSignatureSize,
+              signatures.begin() + to * kSignatureSize);
+    slot_of[ids[to]] = to;
+}
+
+/**
+ * @brief Returns the current box of a track.
+ *
+ * @param id The identifier of the track.
+ * @param box Output receiving the box.
+ * @return False if there is no track with this identifier.
+ */
+bool TrackAI::TrackStore::Box(int id, cv::Rect *box) const {
+    if (id < 0 || id >= static_cast<int>(slot_of.size()) || slot_of[id] < 0) {
+        return false;
+    }
+    const int slot = slot_of[id];
+    *box = cv::Rect(static_cast<int>(std::lround(cx[slot] - width[slot] / 2)),
+                    static_cast<int>(std::lround(cy[slot] - height[slot] / 2)),
+                    static_cast<int>(std::lround(width[slot])),
+                    static_cast<int>(std::lround(height[slot])));
+    return true;
+}
+
+/**
+ * @brief Returns the boxes of the current tracks moved along their velocity to a time.
+ *
+ * @param timestamp Capture time of the frame in seconds.
+ * @param boxes Output receiving one box per current track.
+ */
+void TrackAI::TrackStore::PredictedBoxes(double timestamp,
+    std::vector<cv::Rect> *boxes) const {
+    const float dt = stamp >= 0.0 && timestamp > stamp
+                     ? static_cast<float>(timestamp - stamp) : 0.0f;
+    const size_t n = ids.size();
+    boxes->clear();
+    for (size_t i = 0; i < n; ++i) {
+        if (misses[i] > 0) continue;
+        const float x = cx[i] + vx[i] * dt;
+        const float y = cy[i] + vy[i] * dt;
+        boxes->push_back(cv::Rect(static_cast<int>(std::lround(x - width[i] / 2)),
+                                  static_cast<int>(std::lround(y - height[i] / 2)),
+                                  static_cast<int>(std::lround(width[i])),
+                                  static_cast<int>(std::lround(height[i]))));
+    }
+}
+
+/**
+ * @brief Returns the number of frames since a track was created.
+ *
+ * @param id The identifier of the track.
+ * @return The age of the track, or -1 if there is no such track.
+ */
+int TrackAI::TrackStore::Age(int id) const {
+    if (id < 0 || id >= static_cast<int>(slot_of.size()) || slot_of[id] < 0) {
+        return -1;
+    }
+    return age[slot_of[id]];
+}
+
+/**
+ * @brief Returns the number of tracks.
+ */
+size_t TrackAI::TrackStore::Size() const {
+    return ids.size();
+}
+
+/**
+ * @brief Removes every track and releases every identifier.
+ */
+void TrackAI::TrackStore::Clear() {
+    cx.clear();
+    cy.clear();
+    width.clear();
+    height.clear();
+    vx.clear();
+    vy.clear();
+    age.clear();
+    misses.clear();
+    ids.clear();
+    signatures.clear();
+    slot_of.clear();
+    free_ids.clear();
+    stamp = -1.0;
+}
+
+/**
+ * @brief Computes the appearance signature of a box.
+ *
+ * @param frame The BGR frame.
+ * @param box The box to describe.
+ * @param signature Output receiving kSignatureSize floats.
+ */
+void TrackAI::TrackStore::ComputeSignature(const cv::Mat &frame,
+    const cv::Rect &box, float *signature) {
+    std::fill(signature, signature + kSignatureSize, 0.0f);
+    const cv::Rect roi = box & cv::Rect(0, 0, frame.cols, frame.rows);
+    float total = 0.0f;
+    if (roi.area() > 0 && frame.type() == CV_8UC3) {
+        cv::Mat hsv;
+        cv::cvtColor(frame(roi), hsv, cv::COLOR_BGR2HSV);
+        for (int r = 0; r < hsv.rows; r += 2) {
+            const cv::Vec3b *row = hsv.ptr<cv::Vec3b>(r);
+            for (int c = 0; c < hsv.cols; c += 2) {
+                if (row[c][1] < kMinSaturation) continue;
+                signature[row[c][0] * kSignatureSize / 180] += 1.0f;  // Hue is 0-179
+                total += 1.0f;
+            }
+        }
+    }
+    if (total == 0.0f) {
+        std::fill(signature, signature + kSignatureSize, 1.0f / kSignatureSize);
+        return;
+    }
+    for (int k = 0; k < kSignatureSize; ++k) {
+        signature[k] /= total;
+    }
+}
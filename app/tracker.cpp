@@ -1,13 +1,16 @@
 /**
  * @file tracker.cpp
  * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
- * @brief This file contains the implementation of the Tracker class, which is responsible for 
- *        tracking detected objects in a video frame using the CSRT tracking algorithm.
+ * @brief This file contains the implementation of the Tracker class, which is responsible for
+ *        tracking detected objects in a video frame using one OpenCV tracker per target.
  * @version 0.1
  * @date 2024-10-23
  * @copyright Copyright (c) 2024
  */
 
+#include <algorithm>
+#include <functional>
+#include <opencv2/tracking/tracking_legacy.hpp>
 #include "../include/tracker.hpp"
 
 /**
@@ -15,34 +18,352 @@
  *
  * Initializes the tracker using the CSRT algorithm and sets the initialization flag.
  */
-TrackAI::Tracker::Tracker() {
-    isInitialized = false;  // Flag to check if the tracker is initialized
-    tracker = cv::TrackerCSRT::create();  // Create a new CSRT tracker instance
-}
+TrackAI::Tracker::Tracker() : Tracker(TrackerBackend::CSRT) {}
+
+/**
+ * @brief Constructs a Tracker with the given backend and per-frame budget.
+ *
+ * @param backend The tracking algorithm to use for every target.
+ * @param budget_ms The per-frame tracking budget in milliseconds.
+ */
+TrackAI::Tracker::Tracker(TrackerBackend backend, double budget_ms)
+    : isInitialized(false),
+      backend(backend),
+      budget_ms(budget_ms),
+      over_budget_frames(0),
+      last_track_ms(0.0) {}
 
 /**
  * @brief Tracks objects in the provided video frame.
  *
- * This method either initializes the tracker with the bounding boxes of detected objects
- * or updates the tracker with new positions if it has already been initialized.
+ * Fresh detections always win: every detection becomes a target. Trackers
+ * are only re-seeded for detections their target no longer covers, so a
+ * crowd that is detected on every frame costs one parallel update per frame
+ * rather than one initialization per person. Frames without detections
+ * update the existing targets alone.
  *
  * @param frame The current video frame in which tracking is to be performed.
  * @param bboxes A vector of bounding boxes representing detected objects to track.
  */
 void TrackAI::Tracker::Track(cv::Mat& frame, std::vector<cv::Rect> bboxes) {
-    if (!isInitialized) {
-        // Initialize the tracker with the first set of bounding boxes
-        for (cv::Rect& bbox : bboxes) {
-            cv::rectangle(frame, bbox, cv::Scalar(0, 0, 0), 2);
-            tracker->init(frame, bbox);  // Initialize the tracker
+    int64 start = cv::getTickCount();
+    if (!bboxes.empty()) {
+        if (isInitialized && !targets.empty()) {
+            Follow(frame, bboxes);
+        } else {
+            Init(frame, bboxes);
         }
-        isInitialized = true;  // Set the initialized flag to true
-        return;  // Exit after initialization
+        Charge(frame, start);
+    } else if (isInitialized && !targets.empty()) {
+        // Nothing detected: carry the targets over with the trackers
+        Update(frame);
     }
 
-    // Update the tracker for each bounding box
-    for (cv::Rect& current_box : bboxes) {
-        tracker->update(frame, current_box);  // Updating tracker
+    for (const cv::Rect& current_box : targets) {
         cv::rectangle(frame, current_box, cv::Scalar(0, 0, 0), 2);
     }
 }
+
+/**
+ * @brief Creates and initializes one tracker per bounding box in parallel.
+ *
+ * @param frame The frame the bounding boxes were detected in.
+ * @param bboxes The bounding boxes of the targets to track.
+ */
+void TrackAI::Tracker::Init(const cv::Mat& frame,
+    const std::vector<cv::Rect>& bboxes) {
+    int64 start = cv::getTickCount();
+
+    targets = bboxes;
+    found.assign(bboxes.size(), 1);
+    quality.assign(bboxes.size(), 1.0f);
+
+    if (backend == TrackerBackend::FLOW) {
+        // All targets share a single optical-flow propagator.
+        trackers.clear();
+        flow.Init(frame, targets);
+    } else {
+        trackers.resize(bboxes.size());
+        for (auto &target_tracker : trackers) {
+            target_tracker = Create(backend);
+        }
+
+        cv::parallel_for_(cv::Range(0, static_cast<int>(trackers.size())),
+            [&](const cv::Range &range) {
+                for (int i = range.start; i < range.end; ++i) {
+                    trackers[i]->init(frame, targets[i]);
+                }
+            });
+    }
+
+    isInitialized = true;
+    over_budget_frames = 0;
+    last_track_ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+}
+
+/**
+ * @brief Updates every target in parallel with a new frame.
+ *
+ * Each target owns its own tracker, so the updates are independent and are
+ * spread over the available cores. When the update repeatedly exceeds the
+ * per-frame budget, the trackers are re-created with the next cheaper backend
+ * from the current boxes.
+ *
+ * @param frame The new video frame.
+ * @return The updated bounding box of every target.
+ */
+std::vector<cv::Rect> TrackAI::Tracker::Update(const cv::Mat& frame) {
+    int64 start = cv::getTickCount();
+    Propagate(frame);
+    Charge(frame, start);
+    return targets;
+}
+
+/**
+ * @brief Moves every target along with its tracker, without timing it.
+ *
+ * @param frame The new video frame.
+ */
+void TrackAI::Tracker::Propagate(const cv::Mat& frame) {
+    if (backend == TrackerBackend::FLOW) {
+        targets = flow.Propagate(frame);
+        quality = flow.Quality();
+        for (size_t i = 0; i < targets.size(); ++i) {
+            found[i] = quality[i] > 0.0f ? 1 : 0;
+        }
+    } else {
+        cv::parallel_for_(cv::Range(0, static_cast<int>(trackers.size())),
+            [&](const cv::Range &range) {
+                for (int i = range.start; i < range.end; ++i) {
+                    cv::Rect box = targets[i];
+                    found[i] = trackers[i]->update(frame, box) ? 1 : 0;
+                    quality[i] = found[i] ? 1.0f : 0.0f;
+                    if (found[i]) {
+                        targets[i] = box;  // Keep the last known box on a miss
+                    }
+                }
+            });
+    }
+}
+
+/**
+ * @brief Moves the targets to the detections of a frame.
+ *
+ * The updated targets and the detections are matched greedily, best overlap
+ * first. A matched tracker keeps its state and its target takes the box of
+ * the detection; the other detections get a new tracker, initialized in
+ * parallel. Targets without a detection are dropped. The FLOW backend shares
+ * one propagator, so it is re-seeded as a whole when any target needs it.
+ *
+ * @param frame The frame the bounding boxes were detected in.
+ * @param bboxes The bounding boxes detected in the frame.
+ */
+void TrackAI::Tracker::Follow(const cv::Mat& frame,
+    const std::vector<cv::Rect>& bboxes) {
+    Propagate(frame);
+
+    const int n = static_cast<int>(targets.size());
+    const int m = static_cast<int>(bboxes.size());
+    std::vector<std::pair<double, int>> candidates;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) {
+            const double inter = (targets[i] & bboxes[j]).area();
+            if (inter <= 0.0) continue;
+            const double overlap =
+                inter / (targets[i].area() + bboxes[j].area() - inter);
+            if (overlap >= kReseedOverlap) {
+                candidates.emplace_back(overlap, i * m + j);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              std::greater<std::pair<double, int>>());
+    std::vector<int> target_match(n, -1), detection_match(m, -1);
+    for (const auto &candidate : candidates) {
+        const int i = candidate.second / m;
+        const int j = candidate.second % m;
+        if (target_match[i] >= 0 || detection_match[j] >= 0) continue;
+        target_match[i] = j;
+        detection_match[j] = i;
+    }
+
+    std::vector<int> reseed;
+    for (int j = 0; j < m; ++j) {
+        if (detection_match[j] < 0) reseed.push_back(j);
+    }
+
+    targets = bboxes;
+    found.assign(m, 1);
+    quality.assign(m, 1.0f);
+    if (backend == TrackerBackend::FLOW) {
+        if (!reseed.empty() || n != m) flow.Init(frame, targets);
+        return;
+    }
+
+    std::vector<cv::Ptr<cv::Tracker>> kept(m);
+    for (int j = 0; j < m; ++j) {
+        kept[j] = detection_match[j] >= 0 ? trackers[detection_match[j]]
+                                          : Create(backend);
+    }
+    trackers.swap(kept);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(reseed.size())),
+        [&](const cv::Range &range) {
+            for (int k = range.start; k < range.end; ++k) {
+                trackers[reseed[k]]->init(frame, targets[reseed[k]]);
+            }
+        });
+}
+
+/**
+ * @brief Charges the time since start against the budget, stepping down when over it.
+ *
+ * When the tracking of several consecutive frames exceeded the budget, the
+ * trackers are re-created with the next cheaper backend from the current
+ * boxes.
+ *
+ * @param frame The frame the targets are on.
+ * @param start The tick count at the start of the frame's tracking.
+ */
+void TrackAI::Tracker::Charge(const cv::Mat& frame, int64 start) {
+    last_track_ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+
+    // Step down to a cheaper backend if the budget is exceeded repeatedly.
+    if (budget_ms > 0.0 && last_track_ms > budget_ms) {
+        if (++over_budget_frames >= kDegradeAfterFrames &&
+            backend != TrackerBackend::FLOW) {
+            TrackerBackend cheaper = Cheaper(backend);
+            std::cout << "Tracking took " << last_track_ms << " ms (budget "
+                      << budget_ms << " ms), switching from "
+                      << BackendName(backend) << " to "
+                      << BackendName(cheaper) << std::endl;
+            backend = cheaper;
+            std::vector<cv::Rect> current = targets;
+            Init(frame, current);
+        }
+    } else {
+        over_budget_frames = 0;
+    }
+}
+
+/**
+ * @brief Returns the current bounding box of every target.
+ */
+const std::vector<cv::Rect>& TrackAI::Tracker::Targets() const {
+    return targets;
+}
+
+/**
+ * @brief Returns whether each target was found in the last update.
+ */
+const std::vector<uchar>& TrackAI::Tracker::Found() const {
+    return found;
+}
+
+/**
+ * @brief Returns the quality score of every target in [0, 1].
+ */
+const std::vector<float>& TrackAI::Tracker::Quality() const {
+    return quality;
+}
+
+/**
+ * @brief Returns the backend used for the current trackers.
+ */
+TrackAI::TrackerBackend TrackAI::Tracker::Backend() const {
+    return backend;
+}
+
+/**
+ * @brief Selects the backend used the next time the trackers are initialized.
+ *
+ * @param new_backend The tracking algorithm to use.
+ */
+void TrackAI::Tracker::SetBackend(TrackerBackend new_backend) {
+    backend = new_backend;
+    isInitialized = false;  // Force re-creation on the next Track call
+}
+
+/**
+ * @brief Sets the per-frame tracking budget.
+ *
+ * @param new_budget_ms The budget in milliseconds, zero to disable degradation.
+ */
+void TrackAI::Tracker::SetBudget(double new_budget_ms) {
+    budget_ms = new_budget_ms;
+    over_budget_frames = 0;
+}
+
+/**
+ * @brief Returns the time spent in the last Track, Init or Update call in milliseconds.
+ */
+double TrackAI::Tracker::LastTrackMs() const {
+    return last_track_ms;
+}
+
+/**
+ * @brief Creates a single OpenCV tracker for the given backend.
+ *
+ * @param backend The tracking algorithm to instantiate.
+ * @return A pointer to the created tracker.
+ */
+cv::Ptr<cv::Tracker> TrackAI::Tracker::Create(TrackerBackend backend) {
+    switch (backend) {
+        case TrackerBackend::MIL:
+            return cv::TrackerMIL::create();
+        case TrackerBackend::KCF:
+            return cv::TrackerKCF::create();
+        case TrackerBackend::MOSSE:
+            // MOSSE is only available through the legacy API
+            return cv::legacy::upgradeTrackingAPI(
+                cv::legacy::TrackerMOSSE::create());
+        case TrackerBackend::FLOW:
+            return cv::Ptr<cv::Tracker>();  // Handled by FlowPropagator
+        case TrackerBackend::CSRT:
+        default:
+            return cv::TrackerCSRT::create();
+    }
+}
+
+/**
+ * @brief Returns the backend the Tracker degrades to from a given one.
+ *
+ * MIL is skipped: it is not meaningfully cheaper than CSRT and tracks worse.
+ *
+ * @param backend The current backend.
+ * @return The next cheaper backend, or FLOW for FLOW itself.
+ */
+TrackAI::TrackerBackend TrackAI::Tracker::Cheaper(TrackerBackend backend) {
+    switch (backend) {
+        case TrackerBackend::CSRT:
+        case TrackerBackend::MIL:
+            return TrackerBackend::KCF;
+        case TrackerBackend::KCF:
+            return TrackerBackend::MOSSE;
+        case TrackerBackend::MOSSE:
+        case TrackerBackend::FLOW:
+        default:
+            return TrackerBackend::FLOW;
+    }
+}
+
+/**
+ * @brief Returns the human readable name of a backend.
+ *
+ * @param backend The backend to name.
+ * @return The name of the backend.
+ */
+std::string TrackAI::Tracker::BackendName(TrackerBackend backend) {
+    switch (backend) {
+        case TrackerBackend::MIL:
+            return "MIL";
+        case TrackerBackend::KCF:
+            return "KCF";
+        case TrackerBackend::MOSSE:
+            return "MOSSE";
+        case TrackerBackend::FLOW:
+            return "FLOW";
+        case TrackerBackend::CSRT:
+        default:
+            return "CSRT";
+    }
+}
@@ -34,13 +34,38 @@ void TrackAI::Visualizer::DisplayResults(cv::dnn::Net &net, cv::Mat &human) {
     std::vector<double> layersTimes;
     double freq = cv::getTickFrequency() / 1000;
     double t = net.getPerfProfile(layersTimes) / freq;
-    std::string label = cv::format("Inference time : %.2f ms", t);
+    DisplayResults(t, human);
+}
+
+/**
+ * @brief Displays the results of the object detection process.
+ *
+ * This method draws the given inference time on the provided image, shows the
+ * image in a window and stores it for later video creation. In headless mode
+ * only the label is drawn.
+ *
+ * @param inference_ms The inference time of the frame in milliseconds.
+ * @param human The image in which the results will be displayed.
+ * @param captured The capture time of the frame in steady clock seconds, or a
+ *                 negative value to stamp the recorded frame at display time.
+ */
+void TrackAI::Visualizer::DisplayResults(double inference_ms, cv::Mat &human,
+    double captured) {
+    std::string label = cv::format("Inference time : %.2f ms", inference_ms);
     cv::putText(human, label, cv::Point(20, 40), FONT, 0.7, RED);
+    if (headless) return;  // No window and no video in headless runs
+
     cv::namedWindow("Output", cv::WINDOW_NORMAL);
     cv::imshow("Output", human);
 
-    // Storing the images for video creation
-    images.push_back(human);
+    // Queue a copy for video creation, so the capture buffer can be recycled.
+    // Stamping it with the capture time keeps pipeline latency out of the
+    // measured segment rate.
+    if (captured >= 0.0) {
+        recorder.Push(human, captured);
+    } else {
+        recorder.Push(human);
+    }
 }
 
 /**
@@ -101,13 +126,13 @@ void TrackAI::Visualizer::CreateBoundingBox(
 }
 
 /**
- * @brief Saves the processed images to a video file.
+ * @brief Finishes recording the processed images to video files.
  *
- * This method checks if there are images to save, resizes them to a uniform size,
- * and writes them to a video file in AVI format.
+ * This method waits for the frames still being encoded, finalizes the last
+ * segment with the measured frame rate, and prints the recording statistics.
  */
 void TrackAI::Visualizer::SaveResults() {
-    if (images.empty()) {
+    if (recorder.Stats().pushed == 0) {
         std::cerr << "No images to save to video." << std::endl;
         return;
     }
@@ -115,28 +140,13 @@ void TrackAI::Visualizer::SaveResults() {
     std::cout << std::string(20, '!') << "Saving Results to a video"
               << std::string(20, '!')  << std::endl;
 
-    cv::Size frameSize = images[0].size();
-
-    // Resize all frames to the same size
-    for (auto &image : images) {
-        if (image.size() != frameSize) {
-            cv::resize(image, image, frameSize);
-        }
-    }
-
-    // Use MJPG codec instead of MP4V
-    cv::VideoWriter videoWriter("Results/output.avi",
-    cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 5, frameSize);
+    recorder.Close();
 
-    if (!videoWriter.isOpened()) {
-        std::cerr << "Error opening file" << std::endl;
-        return;
-    }
-
-    for (const auto &image : images) {
-        videoWriter.write(image);
+    TrackAI::RecorderStats stats = recorder.Stats();
+    std::cout << "Recorded " << stats.written << " frames ("
+              << stats.dropped << " dropped) at " << stats.segment_fps
+              << " FPS, encoding " << stats.encode_fps << " frames/s" << std::endl;
+    for (const std::string &segment : recorder.Segments()) {
+        std::cout << "Video saved successfully to " << segment << std::endl;
     }
-
-    videoWriter.release();
-    std::cout << "Video saved successfully to /Results/output.avi" << std::endl;
 }
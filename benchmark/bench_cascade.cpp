@@ -0,0 +1,142 @@
+/**
+ * @file bench_cascade.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the cost and agreement benchmark of the detector cascade stages.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <cstdio>
+#include <fstream>
+#include "../include/detector_cascade.hpp"
+#include "benchmark.hpp"
+
+namespace {
+
+    /**
+    * @brief Counts the boxes of two detections matched one-to-one.
+    *
+    * Every reference box is matched greedily with the unmatched box of
+    * the other detection that overlaps it most, if the intersection over
+    * union reaches the threshold.
+    *
+    * @param reference The boxes taken as ground truth.
+    * @param other The boxes compared against them.
+    * @param iou The smallest intersection over union of a match.
+    * @return The number of matched pairs.
+    */
+    int CountMatches(const std::vector<cv::Rect> &reference,
+                     const std::vector<cv::Rect> &other, double iou) {
+        std::vector<bool> used(other.size(), false);
+        int matches = 0;
+        for (const cv::Rect &box : reference) {
+            int best = -1;
+            double best_iou = iou;
+            for (size_t j = 0; j < other.size(); ++j) {
+                if (used[j]) continue;
+                double overlap = (box & other[j]).area() /
+                                 static_cast<double>((box | other[j]).area());
+                if (overlap >= best_iou) {
+                    best = static_cast<int>(j);
+                    best_iou = overlap;
+                }
+            }
+            if (best >= 0) {
+                used[best] = true;
+                matches++;
+            }
+        }
+        return matches;
+    }
+
+    /**
+    * @brief Keeps the boxes selected by non-maximum suppression.
+    */
+    std::vector<cv::Rect> Kept(const std::vector<cv::Rect> &boxes,
+                               const std::vector<int> &indices) {
+        std::vector<cv::Rect> kept;
+        for (int index : indices) {
+            kept.push_back(boxes[index]);
+        }
+        return kept;
+    }
+
+}  // namespace
+
+/**
+ * @brief Benchmarks the cost and agreement of the detector cascade stages.
+ *
+ * Each frame is detected in every mode. Agreement is measured against the
+ * full-frame DNN: recall is the share of DNN people a stage also finds, and
+ * precision the share of its boxes the DNN confirms, both at an
+ * intersection over union of at least 0.5.
+ *
+ * @param frames The frames to detect on.
+ * @param model_path The path to the ONNX model file.
+ */
+void TrackAI::Bench::BenchCascade(const std::vector<cv::Mat> &frames,
+    const std::string &model_path) {
+    if (frames.empty()) return;
+
+    TrackAI::Detector detector;
+    cv::dnn::Net net;
+    bool has_model = std::ifstream(model_path).good();
+    if (has_model) {
+        std::string path = model_path;
+        net = detector.Load(path, true, true);
+    }
+
+    std::printf("\n== Detector cascade, %zu frames ==\n", frames.size());
+    const TrackAI::CascadeMode modes[] = {TrackAI::CascadeMode::DNN,
+                                          TrackAI::CascadeMode::VERIFY,
+                                          TrackAI::CascadeMode::HOG};
+    std::vector<std::vector<cv::Rect>> reference(frames.size());
+
+    for (TrackAI::CascadeMode mode : modes) {
+        if (!has_model && mode != TrackAI::CascadeMode::HOG) continue;
+
+        TrackAI::DetectorCascade cascade;
+        std::vector<double> latency_ms;
+        int found = 0;
+        int matched = 0;
+        int expected = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            std::vector<int> class_ids, indices;
+            std::vector<float> confidences;
+            std::vector<cv::Rect> boxes;
+            cascade.SetMode(mode);
+
+            int64 start = cv::getTickCount();
+            TrackAI::CascadeMode used = cascade.Detect(detector, net, frames[i],
+                &class_ids, &confidences, &boxes, &indices);
+            latency_ms.push_back(ElapsedMs(start));
+            if (used != mode && i == 0) {
+                std::printf("%-28s ran as %s\n",
+                            TrackAI::DetectorCascade::ModeName(mode).c_str(),
+                            TrackAI::DetectorCascade::ModeName(used).c_str());
+            }
+
+            std::vector<cv::Rect> kept = Kept(boxes, indices);
+            if (mode == TrackAI::CascadeMode::DNN) {
+                reference[i] = kept;
+            }
+            found += static_cast<int>(kept.size());
+            expected += static_cast<int>(reference[i].size());
+            matched += CountMatches(reference[i], kept, 0.5);
+        }
+
+        PrintSummary(TrackAI::DetectorCascade::ModeName(mode) + " latency",
+                     Summarize(latency_ms));
+        if (has_model) {
+            std::printf("%-28s recall %.2f, precision %.2f (%d people, %d boxes)\n",
+                        "  agreement with DNN",
+                        expected > 0 ? matched / static_cast<double>(expected) : 1.0,
+                        found > 0 ? matched / static_cast<double>(found) : 1.0,
+                        expected, found);
+        } else {
+            std::printf("%-28s %d boxes, no model to compare against\n",
+                        "  detections", found);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * @file bench_service.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the throughput benchmark of the DetectorService replica pool.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "../include/detector_service.hpp"
+#include "benchmark.hpp"
+
+/**
+ * @brief Benchmarks the detection throughput for growing replica pools.
+ *
+ * For every pool size, as many threads as replicas detect the frames in a
+ * loop, so the pool is always fully busy. The frame rate of the whole pool
+ * and the memory added per replica are reported.
+ *
+ * @param frames The frames to detect on.
+ * @param model_path The path to the ONNX model file.
+ * @param max_replicas The largest pool size to measure.
+ */
+void TrackAI::Bench::BenchDetectorService(const std::vector<cv::Mat> &frames,
+    const std::string &model_path, int max_replicas) {
+    if (frames.empty() || !std::ifstream(model_path).good()) {
+        std::printf("\n== Detector service skipped, no model at %s ==\n",
+                    model_path.c_str());
+        return;
+    }
+
+    std::printf("\n== Detector service, %zu frames per thread ==\n",
+                frames.size());
+    for (int replicas = 1; replicas <= max_replicas; replicas *= 2) {
+        TrackAI::DetectorService service;
+        service.Load(model_path, replicas, true, true);
+
+        std::atomic<int> detected(0);
+        std::vector<std::thread> callers;
+        int64 start = cv::getTickCount();
+        for (int t = 0; t < replicas; ++t) {
+            callers.emplace_back([&service, &frames, &detected] {
+                for (const cv::Mat &frame : frames) {
+                    std::vector<int> ids;
+                    std::vector<float> scores;
+                    std::vector<cv::Rect> boxes;
+                    std::vector<int> kept;
+                    service.Detect(frame, &ids, &scores, &boxes, &kept);
+                    detected++;
+                }
+            });
+        }
+        for (std::thread &caller : callers) {
+            caller.join();
+        }
+        double elapsed_ms = ElapsedMs(start);
+
+        TrackAI::ServiceStats stats = service.Stats();
+        std::printf("%d replica(s): %7.2f FPS, first replica %.1f MiB, "
+                    "%.1f MiB per additional replica\n", replicas,
+                    detected * 1000.0 / elapsed_ms, stats.first_replica_mb,
+                    stats.per_replica_mb);
+    }
+}
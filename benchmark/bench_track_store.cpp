@@ -0,0 +1,150 @@
+/**
+ * @file bench_track_store.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the crowd-size scaling benchmark of the TrackStore class.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <utility>
+#include "../include/track_store.hpp"
+#include "benchmark.hpp"
+
+namespace {
+
+    /**
+     * @brief Greedy all-pairs IoU association, the cost the grid avoids.
+     *
+     * @param tracks The boxes of the tracks.
+     * @param detections The boxes detected in the frame.
+     * @param matches Output receiving the track matched to every detection, or -1.
+     */
+    void AssociateAllPairs(const std::vector<cv::Rect> &tracks,
+                           const std::vector<cv::Rect> &detections,
+                           std::vector<int> *matches) {
+        std::vector<std::pair<float, int>> candidates;
+        const int m = static_cast<int>(detections.size());
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            for (int j = 0; j < m; ++j) {
+                const int inter = (tracks[i] & detections[j]).area();
+                if (inter == 0) continue;
+                const float iou = static_cast<float>(inter) /
+                    (tracks[i].area() + detections[j].area() - inter);
+                if (iou >= 0.1f) {
+                    candidates.emplace_back(iou, static_cast<int>(i) * m + j);
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  std::greater<std::pair<float, int>>());
+        std::vector<int> track_match(tracks.size(), -1);
+        matches->assign(m, -1);
+        for (const auto &candidate : candidates) {
+            const int i = candidate.second / m;
+            const int j = candidate.second % m;
+            if (track_match[i] >= 0 || (*matches)[j] >= 0) continue;
+            track_match[i] = j;
+            (*matches)[j] = i;
+        }
+    }
+
+}  // namespace
+
+/**
+ * @brief Benchmarks the per-frame cost of the track store against the crowd size.
+ *
+ * Synthetic people walk at constant velocity over a 1920 x 1080 frame and
+ * bounce off its borders; every frame, each is detected with a pixel of
+ * jitter, a few percent are missed and the missed ones are replaced by
+ * newcomers. The full update (predict, age, associate, correct, prune) is
+ * timed for every crowd size, next to a greedy all-pairs IoU association of
+ * the same boxes, and the share of detections that kept their identifier is
+ * reported.
+ *
+ * @param sizes The crowd sizes to measure.
+ * @param frames The number of frames per crowd size.
+ */
+void TrackAI::Bench::BenchTrackStore(const std::vector<int> &sizes, int frames) {
+    const cv::Size frame_size(1920, 1080);
+    const double dt = 1.0 / 30.0;
+
+    std::printf("\n== Track store, %d frames per crowd ==\n", frames);
+    for (int people : sizes) {
+        std::mt19937 random(static_cast<unsigned>(people));
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        std::uniform_int_distribution<int> jitter(-1, 1);
+
+        // Smaller people in larger crowds, like a wider field of view.
+        const int height = std::max(24, std::min(160, 4000 / (people / 10 + 1)));
+        const int width = height / 2;
+        std::vector<cv::Point2f> position(people), velocity(people);
+        std::vector<int> truth(people, -1);
+        for (int p = 0; p < people; ++p) {
+            position[p] = cv::Point2f(uniform(random) * (frame_size.width - width),
+                                      uniform(random) * (frame_size.height - height));
+            velocity[p] = cv::Point2f((uniform(random) - 0.5f) * 120.0f,
+                                      (uniform(random) - 0.5f) * 60.0f);
+        }
+
+        TrackAI::TrackStore store;
+        std::vector<cv::Rect> detections, previous;
+        std::vector<int> owner, ids, matches;
+        std::vector<double> update_ms, all_pairs_ms;
+        size_t kept = 0, continued = 0;
+
+        for (int f = 0; f < frames; ++f) {
+            detections.clear();
+            owner.clear();
+            for (int p = 0; p < people; ++p) {
+                position[p] += velocity[p] * static_cast<float>(dt);
+                if (position[p].x < 0 || position[p].x > frame_size.width - width) {
+                    velocity[p].x = -velocity[p].x;
+                }
+                if (position[p].y < 0 || position[p].y > frame_size.height - height) {
+                    velocity[p].y = -velocity[p].y;
+                }
+                if (uniform(random) < 0.03f) {
+                    truth[p] = -1;  // Missed this frame
+                    continue;
+                }
+                detections.push_back(cv::Rect(
+                    static_cast<int>(position[p].x) + jitter(random),
+                    static_cast<int>(position[p].y) + jitter(random),
+                    width, height));
+                owner.push_back(p);
+            }
+
+            int64 start = cv::getTickCount();
+            store.Update(f * dt, detections, nullptr, &ids);
+            if (f > 0) update_ms.push_back(ElapsedMs(start));
+
+            start = cv::getTickCount();
+            AssociateAllPairs(previous, detections, &matches);
+            if (f > 0) all_pairs_ms.push_back(ElapsedMs(start));
+            previous = detections;
+
+            for (size_t j = 0; j < owner.size(); ++j) {
+                const int p = owner[j];
+                if (truth[p] >= 0) {
+                    continued++;
+                    if (truth[p] == ids[j]) kept++;
+                }
+                truth[p] = ids[j];
+            }
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%4d people, store update", people);
+        PrintSummary(name, Summarize(update_ms));
+        std::snprintf(name, sizeof(name), "%4d people, all-pairs IoU", people);
+        PrintSummary(name, Summarize(all_pairs_ms));
+        std::printf("%4d people: %.1f%% of continued detections kept their id, "
+                    "%zu tracks at the end\n", people,
+                    continued ? 100.0 * kept / continued : 0.0, store.Size());
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file bench_tracker.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the per-backend timing benchmark of the Tracker class.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "../include/tracker.hpp"
+#include "benchmark.hpp"
+
+/**
+ * @brief Benchmarks the per-frame update cost of every tracker backend.
+ *
+ * The targets are laid out on a grid over the first frame, initialized once,
+ * and then updated on every following frame. Initialization and update times
+ * are reported separately for each backend.
+ *
+ * @param frames The frames to track over.
+ * @param targets The number of targets tracked simultaneously.
+ */
+void TrackAI::Bench::BenchTrackers(const std::vector<cv::Mat> &frames,
+    int targets) {
+    if (frames.size() < 2 || targets <= 0) return;
+
+    // Spread the targets over the first frame on a regular grid.
+    const cv::Size size = frames[0].size();
+    const int columns = static_cast<int>(std::ceil(std::sqrt(targets)));
+    const int rows = (targets + columns - 1) / columns;
+    const int cell_w = size.width / columns;
+    const int cell_h = size.height / rows;
+    std::vector<cv::Rect> boxes;
+    for (int i = 0; i < targets; ++i) {
+        boxes.push_back(cv::Rect((i % columns) * cell_w + cell_w / 4,
+                                 (i / columns) * cell_h + cell_h / 4,
+                                 cell_w / 2, cell_h / 2));
+    }
+
+    std::printf("\n== Tracker backends, %d targets, %zu frames ==\n",
+                targets, frames.size());
+    const TrackAI::TrackerBackend backends[] = {
+        TrackAI::TrackerBackend::CSRT, TrackAI::TrackerBackend::MIL,
+        TrackAI::TrackerBackend::KCF, TrackAI::TrackerBackend::MOSSE,
+        TrackAI::TrackerBackend::FLOW};
+
+    for (TrackAI::TrackerBackend backend : backends) {
+        TrackAI::Tracker tracker(backend);
+        std::vector<double> init_ms;
+        std::vector<double> update_ms;
+
+        tracker.Init(frames[0], boxes);
+        init_ms.push_back(tracker.LastTrackMs());
+        for (size_t i = 1; i < frames.size(); ++i) {
+            cv::Mat frame = frames[i];
+            if (frame.size() != size) {
+                cv::resize(frame, frame, size);
+            }
+            tracker.Update(frame);
+            update_ms.push_back(tracker.LastTrackMs());
+        }
+
+        std::string name = TrackAI::Tracker::BackendName(backend);
+        PrintSummary(name + " init", Summarize(init_ms));
+        PrintSummary(name + " update", Summarize(update_ms));
+    }
+}
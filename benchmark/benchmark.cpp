@@ -0,0 +1,264 @@
+/**
+ * @file benchmark.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the implementation of the shared benchmark helpers.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ */
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include "benchmark.hpp"
+
+/**
+ * @brief Computes the distribution of a set of timing samples.
+ *
+ * @param samples_ms The timing samples in milliseconds.
+ * @return The summary of the samples.
+ */
+TrackAI::Bench::Summary TrackAI::Bench::Summarize(
+    std::vector<double> samples_ms) {
+    Summary summary = {0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (samples_ms.empty()) return summary;
+
+    std::sort(samples_ms.begin(), samples_ms.end());
+    auto percentile = [&samples_ms](double p) {
+        size_t idx = static_cast<size_t>(p * (samples_ms.size() - 1) + 0.5);
+        return samples_ms[idx];
+    };
+
+    summary.count = samples_ms.size();
+    summary.mean_ms = std::accumulate(samples_ms.begin(), samples_ms.end(), 0.0)
+                      / samples_ms.size();
+    summary.p50_ms = percentile(0.50);
+    summary.p90_ms = percentile(0.90);
+    summary.p99_ms = percentile(0.99);
+    summary.max_ms = samples_ms.back();
+    return summary;
+}
+
+/**
+ * @brief Prints a one-line summary of a timing distribution.
+ *
+ * @param name The name of the measured quantity.
+ * @param summary The distribution to print.
+ */
+void TrackAI::Bench::PrintSummary(const std::string &name,
+    const Summary &summary) {
+    std::printf("%-28s n=%-5zu mean=%8.3f ms  p50=%8.3f  p90=%8.3f  "
+                "p99=%8.3f  max=%8.3f\n", name.c_str(), summary.count,
+                summary.mean_ms, summary.p50_ms, summary.p90_ms,
+                summary.p99_ms, summary.max_ms);
+}
+
+/**
+ * @brief Returns the time elapsed since a tick count in milliseconds.
+ *
+ * @param start The tick count returned by cv::getTickCount.
+ * @return The elapsed time in milliseconds.
+ */
+double TrackAI::Bench::ElapsedMs(int64 start) {
+    return (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+}
+
+/**
+ * @brief Returns the peak resident set size of the process in MiB.
+ */
+double TrackAI::Bench::PeakRssMb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    return usage.ru_maxrss / 1024.0;  // ru_maxrss is in KiB on Linux
+}
+
+/**
+ * @brief Reads a baseline file written by WriteBaseline.
+ *
+ * The file is a JSON object holding one object of numeric metrics per mode.
+ * Only that shape is understood; anything else is skipped.
+ *
+ * @param path The path of the JSON baseline file.
+ * @param baseline Output receiving the values of every mode.
+ * @return True if the file could be read.
+ */
+bool TrackAI::Bench::ReadBaseline(const std::string &path,
+    Baseline *baseline) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+
+    baseline->clear();
+    std::string mode;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        if (text[pos] == '}') {
+            mode.clear();
+            ++pos;
+            continue;
+        }
+        if (text[pos] != '"') {
+            ++pos;
+            continue;
+        }
+
+        // A quoted key, followed by either a nested object or a number.
+        size_t end = text.find('"', pos + 1);
+        if (end == std::string::npos) break;
+        std::string key = text.substr(pos + 1, end - pos - 1);
+        pos = text.find_first_not_of(" \t\r\n:", end + 1);
+        if (pos == std::string::npos) break;
+
+        if (text[pos] == '{') {
+            mode = key;
+            ++pos;
+        } else if (!mode.empty()) {
+            char *number_end = nullptr;
+            double value = std::strtod(text.c_str() + pos, &number_end);
+            if (number_end != text.c_str() + pos) {
+                (*baseline)[mode][key] = value;
+                pos = number_end - text.c_str();
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Stores a pipeline result in a baseline file.
+ *
+ * @param path The path of the JSON baseline file.
+ * @param result The result to store under its mode.
+ * @return True if the file was written.
+ */
+bool TrackAI::Bench::WriteBaseline(const std::string &path,
+    const PipelineResult &result) {
+    Baseline baseline;
+    ReadBaseline(path, &baseline);  // Keep the values of the other modes
+
+    std::map<std::string, double> &values = baseline[result.mode];
+    values["frames"] = static_cast<double>(result.latency.count);
+    values["mean_ms"] = result.latency.mean_ms;
+    values["p50_ms"] = result.latency.p50_ms;
+    values["p90_ms"] = result.latency.p90_ms;
+    values["p99_ms"] = result.latency.p99_ms;
+    values["max_ms"] = result.latency.max_ms;
+    values["fps"] = result.fps;
+    values["peak_rss_mb"] = result.peak_rss_mb;
+
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+    std::fprintf(file, "{\n");
+    size_t mode_index = 0;
+    for (const auto &mode : baseline) {
+        std::fprintf(file, "  \"%s\": {\n", mode.first.c_str());
+        size_t value_index = 0;
+        for (const auto &value : mode.second) {
+            std::fprintf(file, "    \"%s\": %.3f%s\n", value.first.c_str(),
+                         value.second,
+                         ++value_index < mode.second.size() ? "," : "");
+        }
+        std::fprintf(file, "  }%s\n",
+                     ++mode_index < baseline.size() ? "," : "");
+    }
+    std::fprintf(file, "}\n");
+    return std::fclose(file) == 0;
+}
+
+/**
+ * @brief Compares a pipeline result against the baseline of its mode.
+ *
+ * Each metric is printed with its baseline and limit. Only the median
+ * latency, the frame rate and the peak memory can fail the comparison: the
+ * tail percentiles of a few dozen frames on a shared machine vary too much
+ * to gate on, so they are reported alone. A metric that is missing from the
+ * baseline is not checked.
+ *
+ * @param baseline The baseline values.
+ * @param result The result to check.
+ * @param tolerance The allowed relative regression, e.g. 0.25 for 25 %.
+ * @return The number of regressed metrics, or -1 if the baseline has no
+ *         values for the mode of the result.
+ */
+int TrackAI::Bench::CompareBaseline(const Baseline &baseline,
+    const PipelineResult &result, double tolerance) {
+    auto mode = baseline.find(result.mode);
+    if (mode == baseline.end()) return -1;
+
+    struct Check {
+        const char *name;
+        double value;
+        bool higher_is_worse;
+        bool gated;
+    };
+    const Check checks[] = {
+        {"p50_ms", result.latency.p50_ms, true, true},
+        {"p90_ms", result.latency.p90_ms, true, false},
+        {"p99_ms", result.latency.p99_ms, true, false},
+        {"fps", result.fps, false, true},
+        {"peak_rss_mb", result.peak_rss_mb, true, true}};
+
+    std::printf("\n== Baseline comparison (%s, tolerance %.0f %%) ==\n",
+                result.mode.c_str(), tolerance * 100.0);
+    int regressions = 0;
+    for (const Check &check : checks) {
+        auto expected = mode->second.find(check.name);
+        if (expected == mode->second.end()) continue;
+
+        double limit = check.higher_is_worse
+                       ? expected->second * (1.0 + tolerance)
+                       : expected->second * (1.0 - tolerance);
+        bool regressed = check.higher_is_worse ? check.value > limit
+                                               : check.value < limit;
+        regressions += regressed && check.gated ? 1 : 0;
+        std::printf("%-12s current=%10.3f  baseline=%10.3f  limit=%10.3f  %s\n",
+                    check.name, check.value, expected->second, limit,
+                    !check.gated ? (regressed ? "over (not gated)" : "ok (not gated)")
+                                 : regressed ? "REGRESSED" : "ok");
+    }
+    return regressions;
+}
+
+/**
+ * @brief Loads the bundled sample images, or generates synthetic frames.
+ *
+ * @param folder The folder containing img0.jpg to img9.jpg.
+ * @return The frames to benchmark on.
+ */
+std::vector<cv::Mat> TrackAI::Bench::LoadFrames(const std::string &folder) {
+    std::vector<cv::Mat> frames;
+    for (int i = 0; i < 10; ++i) {
+        cv::Mat frame = cv::imread(folder + "img" + std::to_string(i) + ".jpg");
+        if (!frame.empty()) {
+            frames.push_back(frame);
+        }
+    }
+    if (!frames.empty()) return frames;
+
+    // No sample images available: generate textured frames with moving boxes.
+    std::printf("No images found in %s, using synthetic frames\n",
+                folder.c_str());
+    cv::RNG rng(42);
+    cv::Mat background(480, 640, CV_8UC3);
+    rng.fill(background, cv::RNG::UNIFORM, 0, 255);
+    cv::GaussianBlur(background, background, cv::Size(7, 7), 0);
+    for (int i = 0; i < 10; ++i) {
+        cv::Mat frame = background.clone();
+        for (int j = 0; j < 8; ++j) {
+            cv::Rect person(40 + 70 * j + 3 * i, 120 + 10 * (j % 3) + 2 * i,
+                            50, 150);
+            cv::rectangle(frame, person,
+                          cv::Scalar(30 * j, 255 - 30 * j, 128), cv::FILLED);
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file benchmark.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the shared helpers of the TrackAI benchmark suite.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file declares the frame loading, timing summary and baseline helpers used
+ * by the benchmark executable, together with the entry point of every benchmark.
+ */
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+#pragma once
+
+#include <map>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+namespace TrackAI {
+namespace Bench {
+
+    /**
+    * @struct Summary
+    * @brief Distribution of a set of timing samples in milliseconds.
+    */
+    struct Summary {
+        size_t count;    ///< Number of samples
+        double mean_ms;  ///< Mean of the samples
+        double p50_ms;   ///< Median of the samples
+        double p90_ms;   ///< 90th percentile of the samples
+        double p99_ms;   ///< 99th percentile of the samples
+        double max_ms;   ///< Largest sample
+    };
+
+    /**
+    * @struct PipelineResult
+    * @brief Measurements of one end-to-end replay of the frame set.
+    */
+    struct PipelineResult {
+        std::string mode;     ///< "model" with a loaded network, "synthetic" otherwise
+        Summary latency;      ///< Per-frame latency of the measured passes
+        double fps;           ///< Sustained throughput over the measured passes
+        double peak_rss_mb;   ///< Peak resident set size of the process in MiB
+    };
+
+    /**
+    * @brief Baseline values, grouped by mode and then by metric name.
+    */
+    typedef std::map<std::string, std::map<std::string, double>> Baseline;
+
+    /**
+    * @brief Computes the distribution of a set of timing samples.
+    *
+    * @param samples_ms The timing samples in milliseconds.
+    * @return The summary of the samples.
+    */
+    Summary Summarize(std::vector<double> samples_ms);
+
+    /**
+    * @brief Prints a one-line summary of a timing distribution.
+    *
+    * @param name The name of the measured quantity.
+    * @param summary The distribution to print.
+    */
+    void PrintSummary(const std::string &name, const Summary &summary);
+
+    /**
+    * @brief Returns the time elapsed since a tick count in milliseconds.
+    *
+    * @param start The tick count returned by cv::getTickCount.
+    * @return The elapsed time in milliseconds.
+    */
+    double ElapsedMs(int64 start);
+
+    /**
+    * @brief Returns the peak resident set size of the process in MiB.
+    */
+    double PeakRssMb();
+
+    /**
+    * @brief Reads a baseline file written by WriteBaseline.
+    *
+    * @param path The path of the JSON baseline file.
+    * @param baseline Output receiving the values of every mode.
+    * @return True if the file could be read.
+    */
+    bool ReadBaseline(const std::string &path, Baseline *baseline);
+
+    /**
+    * @brief Stores a pipeline result in a baseline file.
+    *
+    * The values of the other modes already in the file are kept.
+    *
+    * @param path The path of the JSON baseline file.
+    * @param result The result to store under its mode.
+    * @return True if the file was written.
+    */
+    bool WriteBaseline(const std::string &path, const PipelineResult &result);
+
+    /**
+    * @brief Compares a pipeline result against the baseline of its mode.
+    *
+    * The median latency and the memory may grow, and the frame rate may
+    * drop, by at most the given fraction of the baseline value. The tail
+    * latencies are reported but do not count as regressions.
+    *
+    * @param baseline The baseline values.
+    * @param result The result to check.
+    * @param tolerance The allowed relative regression, e.g. 0.25 for 25 %.
+    * @return The number of regressed metrics, or -1 if the baseline has no
+    *         values for the mode of the result.
+    */
+    int CompareBaseline(const Baseline &baseline, const PipelineResult &result,
+                        double tolerance);
+
+    /**
+    * @brief Loads the bundled sample images.
+    *
+    * When no image can be read from the folder, a deterministic set of
+    * synthetic frames with moving rectangles is generated instead.
+    *
+    * @param folder The folder containing img0.jpg to img9.jpg.
+    * @return The frames to benchmark on.
+    */
+    std::vector<cv::Mat> LoadFrames(const std::string &folder);
+
+    /**
+    * @brief Benchmarks the per-frame update cost of every tracker backend.
+    *
+    * @param frames The frames to track over.
+    * @param targets The number of targets tracked simultaneously.
+    */
+    void BenchTrackers(const std::vector<cv::Mat> &frames, int targets);
+
+    /**
+    * @brief Benchmarks the detection throughput for growing replica pools.
+    *
+    * Pools of 1, 2, 4, ... replicas up to max_replicas are measured. The
+    * benchmark is skipped when the model file does not exist.
+    *
+    * @param frames The frames to detect on.
+    * @param model_path The path to the ONNX model file.
+    * @param max_replicas The largest pool size to measure.
+    */
+    void BenchDetectorService(const std::vector<cv::Mat> &frames,
+                              const std::string &model_path, int max_replicas);
+
+    /**
+    * @brief Replays the frames through the full Robot pipeline.
+    *
+    * Every frame goes through detection, postprocessing, tracking and the
+    * robot frame transform, headless. Without a model file, the forward pass
+    * is replaced by synthetic network outputs and only the remaining stages
+    * are measured. The first pass is a warm-up and is not measured.
+    *
+    * @param frames The frames to replay.
+    * @param model_path The path to the ONNX model file.
+    * @param passes The number of passes over the frames, including the warm-up.
+    * @return The measurements of the replay.
+    */
+    PipelineResult BenchPipeline(const std::vector<cv::Mat> &frames,
+                                 const std::string &model_path, int passes);
+
+    /**
+    * @brief Benchmarks the cost and agreement of the detector cascade stages.
+    *
+    * Every frame is detected by the full-frame DNN, by HOG proposals verified
+    * by the DNN, and by HOG alone. The latency of each mode and the recall
+    * and precision of the cheaper modes against the DNN are reported. Without
+    * a model file only HOG is measured.
+    *
+    * @param frames The frames to detect on.
+    * @param model_path The path to the ONNX model file.
+    */
+    void BenchCascade(const std::vector<cv::Mat> &frames,
+                      const std::string &model_path);
+
+    /**
+    * @brief Replays the frames through the Robot pipeline with region refinement.
+    *
+    * Reports the latency with refinement enabled, the share of frames
+    * detected from crops alone, the fallbacks to a full-frame pass and the
+    * network input compute saved. Skipped when the model file does not exist.
+    *
+    * @param frames The frames to replay, in sequence.
+    * @param model_path The path to the ONNX model file.
+    * @param passes The number of passes over the frames, including the warm-up.
+    */
+    void BenchRefinement(const std::vector<cv::Mat> &frames,
+                         const std::string &model_path, int passes);
+
+    /**
+    * @brief Benchmarks the per-frame cost of the track store against the crowd size.
+    *
+    * Synthetic crowds are tracked through the store and, for comparison,
+    * associated by greedy all-pairs IoU. No frames or model are needed.
+    *
+    * @param sizes The crowd sizes to measure.
+    * @param frames The number of frames per crowd size.
+    */
+    void BenchTrackStore(const std::vector<int> &sizes, int frames);
+
+}  // namespace Bench
+}  // namespace TrackAI
+
+#endif  // __BENCHMARK_H__
@@ -0,0 +1,108 @@
+/**
+ * @file main.cpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file serves as the entry point of the TrackAI benchmark suite.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * Usage:
+ *   TrackAI-bench [image_folder] [--model <onnx>] [--passes <n>]
+ *                 [--baseline <json>] [--tolerance <fraction>] [--write-baseline]
+ *
+ * With --baseline, the end-to-end results are compared against the checked-in
+ * baseline and the process exits with a non-zero status on a regression, or
+ * when the baseline has no values for the current mode. With
+ * --write-baseline, the results are stored in the baseline file instead.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "benchmark.hpp"
+
+/**
+ * @brief Runs every benchmark of the TrackAI benchmark suite.
+ *
+ * @param argc Argument count from the command line.
+ * @param argv Argument vector, see the usage above.
+ * @return int Returns 0 upon success, 1 on a performance regression and 2 on
+ *         invalid arguments, or an unreadable baseline or one without values
+ *         for the current mode.
+ */
+int main(int argc, char** argv) {
+  std::string folder = "../../Data/Images/";
+  std::string model_path = "../../Data/Model/yolov8s.onnx";
+  std::string baseline_path;
+  double tolerance = 0.25;
+  int passes = 3;
+  bool write_baseline = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--model" && has_value) {
+      model_path = argv[++i];
+    } else if (arg == "--passes" && has_value) {
+      passes = std::atoi(argv[++i]);
+    } else if (arg == "--baseline" && has_value) {
+      baseline_path = argv[++i];
+    } else if (arg == "--tolerance" && has_value) {
+      tolerance = std::atof(argv[++i]);
+    } else if (arg == "--write-baseline") {
+      write_baseline = true;
+    } else if (arg.compare(0, 2, "--") != 0) {
+      folder = arg;
+    } else {
+      std::fprintf(stderr, "Unknown or incomplete option: %s\n", arg.c_str());
+      return 2;
+    }
+  }
+  if (write_baseline && baseline_path.empty()) {
+    std::fprintf(stderr, "--write-baseline requires --baseline <json>\n");
+    return 2;
+  }
+
+  std::vector<cv::Mat> frames = TrackAI::Bench::LoadFrames(folder);
+
+  // The end-to-end replay runs first: its peak RSS is the process lifetime
+  // peak, which the replica pool and the other benchmarks would inflate.
+  TrackAI::Bench::PipelineResult result =
+      TrackAI::Bench::BenchPipeline(frames, model_path, passes);
+  TrackAI::Bench::BenchRefinement(frames, model_path, passes);
+  TrackAI::Bench::BenchTrackers(frames, 20);
+  TrackAI::Bench::BenchTrackStore({10, 100, 1000}, 300);
+  TrackAI::Bench::BenchCascade(frames, model_path);
+  TrackAI::Bench::BenchDetectorService(
+      frames, model_path,
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2));
+
+  if (baseline_path.empty()) return 0;
+
+  if (write_baseline) {
+    if (!TrackAI::Bench::WriteBaseline(baseline_path, result)) {
+      std::fprintf(stderr, "Could not write %s\n", baseline_path.c_str());
+      return 2;
+    }
+    std::printf("Baseline for %s written to %s\n", result.mode.c_str(),
+                baseline_path.c_str());
+    return 0;
+  }
+
+  TrackAI::Bench::Baseline baseline;
+  if (!TrackAI::Bench::ReadBaseline(baseline_path, &baseline)) {
+    std::fprintf(stderr, "Could not read %s\n", baseline_path.c_str());
+    return 2;
+  }
+  int regressions = TrackAI::Bench::CompareBaseline(baseline, result, tolerance);
+  if (regressions < 0) {
+    // An empty baseline must not pass the gate silently.
+    std::fprintf(stderr, "No %s baseline in %s, write one with --write-baseline\n",
+                 result.mode.c_str(), baseline_path.c_str());
+    return 2;
+  }
+  std::printf("%d metric(s) regressed\n", regressions);
+  return regressions > 0 ? 1 : 0;
+}
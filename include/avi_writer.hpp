@@ -0,0 +1,100 @@
+/**
+ * @file avi_writer.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the AviWriter class, a minimal
+ *        Motion-JPEG AVI muxer for pre-encoded frames.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the AviWriter class, which writes already JPEG-encoded frames
+ * into an AVI container without re-encoding them, and patches the frame count and
+ * frame rate into the headers when the file is closed.
+ */
+
+#ifndef __AVI_WRITER_H__
+#define __AVI_WRITER_H__
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace TrackAI {
+
+    /**
+    * @class AviWriter
+    * @brief A minimal Motion-JPEG AVI muxer.
+    *
+    * Frames are appended as '00dc' chunks of the movi list. The idx1 index, the
+    * total frame count and the frame rate are written by Close, so the frame
+    * rate can be the one actually measured over the recorded frames.
+    */
+    class AviWriter {
+        std::FILE *file;                 ///< The output file, null when closed
+        int width;                       ///< Frame width in pixels
+        int height;                      ///< Frame height in pixels
+        uint32_t frames;                 ///< Number of frames written
+        uint32_t max_frame_bytes;        ///< Largest encoded frame, used as suggested buffer size
+        long movi_offset;                ///< File offset of the 'movi' list type
+        std::vector<uint32_t> index;     ///< Offset and size of every frame chunk, pairwise
+
+        void Put32(uint32_t value);
+        void Put16(uint16_t value);
+        void PutFourcc(const char *fourcc);
+        void Patch32(long offset, uint32_t value);
+
+        public:
+            /**
+            * @brief Constructs a closed AviWriter.
+            */
+            AviWriter();
+
+            /**
+            * @brief Finalizes the file if it is still open.
+            */
+            ~AviWriter();
+
+            AviWriter(const AviWriter &) = delete;
+            AviWriter &operator=(const AviWriter &) = delete;
+
+            /**
+            * @brief Creates the file and writes the headers.
+            *
+            * @param path The path of the AVI file.
+            * @param frame_width The width of every frame.
+            * @param frame_height The height of every frame.
+            * @return False if the file could not be created.
+            */
+            bool Open(const std::string &path, int frame_width, int frame_height);
+
+            /**
+            * @brief Appends one JPEG-encoded frame.
+            *
+            * @param jpeg The encoded frame.
+            * @return False if the write failed.
+            */
+            bool WriteFrame(const std::vector<unsigned char> &jpeg);
+
+            /**
+            * @brief Writes the index, patches the headers and closes the file.
+            *
+            * @param fps The frame rate stored in the headers.
+            */
+            void Close(double fps);
+
+            /**
+            * @brief Returns whether a file is open.
+            */
+            bool IsOpen() const;
+
+            /**
+            * @brief Returns the number of frames written to the current file.
+            */
+            uint32_t Frames() const;
+    };
+
+} // namespace TrackAI
+
+#endif  // __AVI_WRITER_H__
@@ -16,13 +16,34 @@
 #pragma once
 
 #include <opencv2/core/mat.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <opencv2/dnn.hpp>
 #include <opencv2/core.hpp>
+#include <string>
+#include <thread>
 #include <vector>
+#include "output_decoder.hpp"
 
 namespace TrackAI {
 
+    /**
+    * @struct AsyncStats
+    * @brief Counters of the asynchronous inference API of the Detector.
+    */
+    struct AsyncStats {
+        uint64 submitted;          ///< Number of frames submitted
+        uint64 completed;          ///< Number of frames whose inference finished
+        int in_flight;             ///< Frames currently queued, running or awaiting collection
+        int max_in_flight;         ///< Largest in-flight depth observed
+        double last_latency_ms;    ///< Submit-to-result latency of the last completed frame
+        double mean_latency_ms;    ///< Mean submit-to-result latency of all completed frames
+    };
+
     /**
     * @class Detector
     * @brief A class for handling object detection using a deep learning model.
@@ -30,7 +51,8 @@ namespace TrackAI {
     * The Detector class encapsulates the functionality required to load a 
     * detection model, preprocess images for the model, and postprocess 
     * the detection results to extract bounding boxes, class IDs, and 
-    * confidence scores.
+    * confidence scores. Inference can also run asynchronously on an internal
+    * thread through Submit, Poll and Wait.
     */
     class Detector {
         float input_height;          ///< The height of the input image for the model
@@ -39,6 +61,96 @@ namespace TrackAI {
         float NMS_THRESHOLD;         ///< The threshold for non-maximum suppression
 
         cv::dnn::Net net;           ///< The DNN model for object detection
+        std::vector<std::string> output_names;  ///< Names of the output layers of the model
+        std::atomic<double> inference_ms;  ///< Duration of the last forward pass in milliseconds
+
+        bool person_only;              ///< Whether only the person class is decoded
+        OutputFormat output_format;    ///< Shape of the model output the decoder was selected for
+        DecodeFunction decode;         ///< Decoder instantiation matching the model output
+        OutputFormat region_format;    ///< Shape of a region output the region decoder was selected for
+        DecodeFunction region_decode;  ///< Decoder instantiation matching the region outputs
+
+        /**
+        * @brief Selects the decoder for the shape of a model output.
+        *
+        * @param output The first output tensor of the model.
+        * @throws std::runtime_error If the shape is not a supported YOLO output.
+        */
+        void SelectDecoderFor(const cv::Mat &output);
+
+        /**
+        * @brief Appends a slice layer keeping only the box and person channels
+        *        of the model output.
+        *
+        * @throws std::runtime_error If the shape is not a supported YOLO output.
+        */
+        void PruneToPerson();
+
+        /**
+        * @brief Configures a freshly read network and selects its decoder.
+        *
+        * @param person_only Whether only the person class is decoded.
+        * @param prune_head Whether the output is sliced to the person channels.
+        * @param weights A detector already loaded from the same model whose
+        *                layer weights are taken, or nullptr.
+        */
+        void Prepare(bool person_only, bool prune_head, const Detector *weights);
+
+        /**
+        * @brief Replaces the weights of every layer by those of another network.
+        *
+        * Only the layer blobs are shared; the network may still hold the
+        * copy it parsed, so the memory saved is not guaranteed.
+        *
+        * @param source A network read from the same model.
+        */
+        void ShareWeights(cv::dnn::Net source);
+
+        /**
+        * @struct InferenceSlot
+        * @brief One input/output buffer pair of the asynchronous pipeline.
+        */
+        struct InferenceSlot {
+            enum State { FREE, QUEUED, RUNNING, DONE };
+            State state;                     ///< Stage of the frame held by the slot
+            uint64 ticket;                   ///< Ticket of the frame held by the slot
+            int64 submit_tick;               ///< Tick count at submission
+            std::chrono::steady_clock::time_point completed;  ///< End of the forward pass
+            cv::Mat blob;                    ///< Input blob, reused across frames
+            std::vector<cv::Mat> outputs;    ///< Copy of the network outputs, reused across frames
+            std::string error;               ///< Error raised by the forward pass, if any
+        };
+
+        static const int kMaxInFlight = 2;   ///< Number of inference slots (double buffering)
+        InferenceSlot slots[kMaxInFlight];   ///< Buffers of the frames in flight
+        std::deque<int> queue;               ///< Slots waiting for the inference thread, in order
+        std::thread worker;                  ///< The inference thread, started on first Submit
+        std::mutex mutex;                    ///< Guards the slots, the queue and the statistics
+        std::condition_variable work_ready;  ///< Signals the worker that a slot was queued
+        std::condition_variable slot_done;   ///< Signals callers that a slot finished or was freed
+        bool stopping;                       ///< Set by the destructor to stop the worker
+        uint64 next_ticket;                  ///< Ticket assigned to the next submitted frame
+        AsyncStats stats;                    ///< Asynchronous inference counters
+
+        /**
+        * @brief Body of the inference thread.
+        *
+        * Runs the forward pass of every queued slot in submission order and
+        * copies the outputs into the slot so they survive the next forward pass.
+        */
+        void InferenceLoop();
+
+        /**
+        * @brief Returns the slot holding a ticket, or -1. Requires the mutex.
+        */
+        int FindSlot(uint64 ticket) const;
+
+        /**
+        * @brief Hands the outputs of a finished slot to the caller and frees it.
+        *        Requires the mutex.
+        */
+        std::vector<cv::Mat> Collect(int slot,
+                                     std::chrono::steady_clock::time_point *completed);
 
         public:
               std::vector<std::string> class_list; ///< List of class names for detected objects
@@ -51,17 +163,56 @@ namespace TrackAI {
               */
               Detector();
 
+              /**
+              * @brief Stops the inference thread, discarding frames still in flight.
+              */
+              ~Detector();
+
+              Detector(const Detector &) = delete;
+              Detector &operator=(const Detector &) = delete;
+
               /**
               * @brief Loads the deep learning model for detection.
               *
               * This method loads the model from the specified path and 
-              * initializes the DNN network.
+              * initializes the DNN network. A warm-up forward pass reveals the
+              * output layout and class count, from which the decoder used by
+              * PostProcess is selected.
               *
               * @param model_path A reference to a string containing the path 
               *                   to the model file.
+              * @param person_only Whether only the person class is decoded. When
+              *                    false, every class of the model is reported.
+              * @param prune_head Whether a slice layer is appended so the network
+              *                   only outputs the box and person channels, about
+              *                   16 times less data for an 80-class model. Only
+              *                   used together with person_only.
               * @return The loaded DNN network.
               */
-              cv::dnn::Net Load(std::string &model_path);
+              cv::dnn::Net Load(std::string &model_path, bool person_only = true,
+                                bool prune_head = false);
+
+              /**
+              * @brief Loads the deep learning model from an ONNX file held in memory.
+              *
+              * Replicas of a network are created by loading the same buffer
+              * again and passing the first detector as weights, whose layer
+              * blobs the replica then points at.
+              *
+              * @param model_data The content of the ONNX model file.
+              * @param person_only Whether only the person class is decoded.
+              * @param prune_head Whether the output is sliced to the person channels.
+              * @param weights A detector already loaded from the same model, or nullptr.
+              * @return The loaded DNN network.
+              */
+              cv::dnn::Net Load(const std::vector<uchar> &model_data,
+                                bool person_only = true, bool prune_head = false,
+                                const Detector *weights = nullptr);
+
+              /**
+              * @brief Returns the output format the decoder was selected for.
+              */
+              OutputFormat Format() const;
 
               /**
               * @brief Preprocesses the input image for the DNN model.
@@ -75,12 +226,70 @@ namespace TrackAI {
               */
               std::vector<cv::Mat> PreProcess(cv::Mat &input, cv::dnn::Net &model);
 
+              /**
+              * @brief Submits a frame for asynchronous inference.
+              *
+              * The frame is converted to a blob on the calling thread and the
+              * forward pass runs on the internal inference thread. At most
+              * kMaxInFlight frames can be in flight; when all slots are busy the
+              * call blocks until a result is collected with Poll or Wait.
+              * The asynchronous API must not be mixed with concurrent PreProcess
+              * calls on the same network.
+              *
+              * @param frame The input image.
+              * @return The ticket identifying the frame.
+              * @throws cv::Exception If the frame cannot be converted to a blob,
+              *         e.g. an empty frame. No slot stays taken.
+              */
+              uint64 Submit(const cv::Mat &frame);
+
+              /**
+              * @brief Collects the result of a submitted frame if it is ready.
+              *
+              * @param ticket The ticket returned by Submit.
+              * @param outputs Receives the raw network outputs when ready.
+              * @param completed Optional output receiving the time the forward
+              *                  pass finished on the inference thread.
+              * @return True if the result was ready and has been collected.
+              * @throws std::runtime_error If the ticket is unknown or inference failed.
+              */
+              bool Poll(uint64 ticket, std::vector<cv::Mat> *outputs,
+                        std::chrono::steady_clock::time_point *completed = nullptr);
+
+              /**
+              * @brief Waits for and collects the result of a submitted frame.
+              *
+              * A result may be collected long after its forward pass
+              * finished, so the time it finished is reported separately.
+              *
+              * @param ticket The ticket returned by Submit.
+              * @param completed Optional output receiving the time the forward
+              *                  pass finished on the inference thread.
+              * @return The raw network outputs, as returned by PreProcess.
+              * @throws std::runtime_error If the ticket is unknown or inference failed.
+              */
+              std::vector<cv::Mat> Wait(uint64 ticket,
+                  std::chrono::steady_clock::time_point *completed = nullptr);
+
+              /**
+              * @brief Returns the counters of the asynchronous inference API.
+              */
+              AsyncStats Stats();
+
+              /**
+              * @brief Returns the duration of the last forward pass in milliseconds.
+              */
+              double InferenceMs() const;
+
               /**
               * @brief Postprocesses the detection results.
               *
               * This method processes the raw output from the model to extract 
               * bounding boxes, class IDs, and confidence scores, applying 
               * non-maximum suppression to filter out duplicate detections.
+              * The output is decoded in place by the decoder selected at Load;
+              * without a loaded model the decoder is selected from the first
+              * output seen.
               *
               * @param input_image The original input image used for detection.
               * @param detections A vector of raw detection outputs from the model.
@@ -94,6 +303,49 @@ namespace TrackAI {
                                   std::vector<int> *class_ids, std::vector<float> *confidences,
                                   std::vector<cv::Rect> *boxes, std::vector<int> *indices);
 
+              /**
+              * @brief Runs one batched forward pass over regions of a frame.
+              *
+              * Every region is cropped and resized to the region input size,
+              * normally much smaller than the full-frame input, and the crops
+              * are stacked into a single blob. The model must accept that
+              * input size and batch size, e.g. an ONNX export with dynamic axes.
+              *
+              * @param frame The full frame.
+              * @param regions The regions to detect in, inside the frame.
+              * @param region_input The network input size of a region.
+              * @param model The DNN model.
+              * @return The raw network outputs, one batch item per region.
+              */
+              std::vector<cv::Mat> PreProcessRegions(const cv::Mat &frame,
+                                                     const std::vector<cv::Rect> &regions,
+                                                     cv::Size region_input,
+                                                     cv::dnn::Net &model);
+
+              /**
+              * @brief Postprocesses the outputs of PreProcessRegions into frame coordinates.
+              *
+              * The candidates of every region are decoded, moved from the
+              * region to the frame, and filtered by a single non-maximum
+              * suppression, which also merges people seen by two regions.
+              *
+              * @param detections The raw outputs returned by PreProcessRegions.
+              * @param regions The regions passed to PreProcessRegions.
+              * @param region_input The network input size of a region.
+              * @param class_ids A pointer to a vector to store detected class IDs.
+              * @param confidences A pointer to a vector to store confidence scores.
+              * @param boxes A pointer to a vector to store bounding boxes in the frame.
+              * @param indices A pointer to a vector to store indices of the filtered detections.
+              * @throws std::runtime_error If the outputs do not match the regions.
+              */
+              void PostProcessRegions(std::vector<cv::Mat> &detections,
+                                      const std::vector<cv::Rect> &regions,
+                                      cv::Size region_input,
+                                      std::vector<int> *class_ids,
+                                      std::vector<float> *confidences,
+                                      std::vector<cv::Rect> *boxes,
+                                      std::vector<int> *indices);
+
               /**
               * @brief Converts an image to a square format.
               *
@@ -0,0 +1,177 @@
+/**
+ * @file detector_cascade.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the DetectorCascade class, a cheaper
+ *        person detection path for overloaded hosts.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the DetectorCascade class, which pairs the DNN detector
+ * with OpenCV's HOG people detector run on a downscaled frame. The HOG stage
+ * either replaces the DNN or proposes the regions the DNN verifies, and the
+ * cascade switches between these modes from the measured frame latency.
+ */
+
+#ifndef __DETECTOR_CASCADE_H__
+#define __DETECTOR_CASCADE_H__
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+#include <opencv2/objdetect.hpp>
+#include <string>
+#include <vector>
+#include "detector.hpp"
+
+namespace TrackAI {
+
+    /**
+    * @brief The detection modes of the DetectorCascade.
+    *
+    * The modes are ordered from the most expensive to the cheapest, which is
+    * the order the cascade walks through when it degrades under load.
+    */
+    enum class CascadeMode {
+        DNN,      ///< Full-frame DNN detection
+        VERIFY,   ///< HOG proposals verified by the DNN on crops around them
+        HOG       ///< HOG people detector alone
+    };
+
+    /**
+    * @struct CascadeStats
+    * @brief Counters of the DetectorCascade.
+    */
+    struct CascadeStats {
+        uint64 dnn_frames;       ///< Frames detected by the full-frame DNN
+        uint64 verify_frames;    ///< Frames detected by verified HOG proposals
+        uint64 hog_frames;       ///< Frames detected by HOG alone
+        uint64 switches;         ///< Mode changes made by the latency control
+        uint64 proposals;        ///< HOG proposals passed to the DNN for verification
+        double latency_ema_ms;   ///< Moving average of the reported frame latency
+    };
+
+    /**
+    * @class DetectorCascade
+    * @brief Person detection with a HOG first stage and a DNN second stage.
+    *
+    * The HOG detector runs on the frame downscaled by a fixed factor, and its
+    * boxes are mapped back to the frame. In VERIFY mode the proposals are
+    * padded into crops that the DNN detects in as a single batch, so only
+    * people the DNN confirms are reported.
+    *
+    * When a budget is set, the frame latency reported after every frame is
+    * smoothed by an exponential moving average. The cascade steps down to the
+    * next cheaper mode when the average exceeds the budget for several frames
+    * in a row, and back up when it stays well below the budget.
+    */
+    class DetectorCascade {
+        cv::HOGDescriptor hog;     ///< The HOG people detector
+        double scale;              ///< Downscaling factor of the frame seen by HOG
+        double budget_ms;          ///< Frame latency budget in milliseconds (0 disables switching)
+        double latency_ema_ms;     ///< Moving average of the frame latency in milliseconds
+        int over_budget_frames;    ///< Consecutive frames with the average above the budget
+        int under_budget_frames;   ///< Consecutive frames with the average well below the budget
+        bool verify_supported;     ///< Cleared once the model rejects a crop batch
+        CascadeMode mode;          ///< The current mode
+        CascadeStats stats;        ///< Counters reported by Stats
+        std::vector<cv::Rect> proposals;  ///< Scratch: HOG boxes of the current frame
+        std::vector<cv::Rect> regions;    ///< Scratch: crops verified by the DNN
+
+        public:
+            /**
+            * @brief Frames above the budget before stepping down to a cheaper mode.
+            */
+            static const int kDegradeAfterFrames = 3;
+
+            /**
+            * @brief Frames well below the budget before stepping up to a dearer mode.
+            */
+            static const int kRecoverAfterFrames = 30;
+
+            /**
+            * @brief Constructs a cascade in DNN mode.
+            *
+            * @param budget_ms The frame latency budget in milliseconds. A value
+            *                  of zero keeps the current mode.
+            * @param scale The downscaling factor of the frame seen by HOG.
+            */
+            explicit DetectorCascade(double budget_ms = 0.0, double scale = 0.5);
+
+            /**
+            * @brief Detects the people of a frame in the current mode.
+            *
+            * The outputs have the same meaning as those of Detector::PostProcess.
+            *
+            * @param detector The detector, loaded with the model. Unused in HOG mode.
+            * @param net The network returned by Detector::Load. Unused in HOG mode.
+            * @param frame The frame to detect in.
+            * @param class_ids A pointer to a vector to store detected class IDs.
+            * @param confidences A pointer to a vector to store confidence scores.
+            * @param boxes A pointer to a vector to store bounding boxes.
+            * @param indices A pointer to a vector to store indices of the filtered detections.
+            * @return The mode the frame was detected in.
+            */
+            CascadeMode Detect(Detector &detector, cv::dnn::Net &net, const cv::Mat &frame,
+                               std::vector<int> *class_ids, std::vector<float> *confidences,
+                               std::vector<cv::Rect> *boxes, std::vector<int> *indices);
+
+            /**
+            * @brief Runs the HOG people detector alone.
+            *
+            * The confidence of a box is the logistic function of its SVM score.
+            *
+            * @param frame The frame to detect in.
+            * @param class_ids A pointer to a vector to store the person class ID.
+            * @param confidences A pointer to a vector to store confidence scores.
+            * @param boxes A pointer to a vector to store bounding boxes.
+            * @param indices A pointer to a vector to store indices of the filtered detections.
+            */
+            void DetectHog(const cv::Mat &frame, std::vector<int> *class_ids,
+                           std::vector<float> *confidences, std::vector<cv::Rect> *boxes,
+                           std::vector<int> *indices);
+
+            /**
+            * @brief Feeds the latency of a frame to the mode control.
+            *
+            * @param frame_ms The time from capture to result of the frame in milliseconds.
+            * @return The mode for the next frame.
+            */
+            CascadeMode ReportLatency(double frame_ms);
+
+            /**
+            * @brief Returns the current mode.
+            */
+            CascadeMode Mode() const;
+
+            /**
+            * @brief Forces a mode, e.g. to benchmark it.
+            *
+            * @param new_mode The mode for the next frame.
+            */
+            void SetMode(CascadeMode new_mode);
+
+            /**
+            * @brief Sets the frame latency budget.
+            *
+            * @param new_budget_ms The budget in milliseconds, zero to disable switching.
+            */
+            void SetBudget(double new_budget_ms);
+
+            /**
+            * @brief Returns the counters of the cascade.
+            */
+            CascadeStats Stats() const;
+
+            /**
+            * @brief Returns the human readable name of a mode.
+            *
+            * @param mode The mode to name.
+            * @return The name of the mode.
+            */
+            static std::string ModeName(CascadeMode mode);
+    };
+
+} // namespace TrackAI
+
+#endif  // __DETECTOR_CASCADE_H__
@@ -0,0 +1,143 @@
+/**
+ * @file detector_service.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the DetectorService class for concurrent detection.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the DetectorService class, which owns a pool of Detector
+ * replicas loaded from one model file. Every call is checked out
+ * to a free replica, so detection can be requested from any number of threads.
+ */
+
+#ifndef __DETECTOR_SERVICE_H__
+#define __DETECTOR_SERVICE_H__
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "detector.hpp"
+
+namespace TrackAI {
+
+    /**
+    * @struct ServiceStats
+    * @brief Counters and memory usage of a DetectorService.
+    */
+    struct ServiceStats {
+        size_t replicas;            ///< Number of network replicas in the pool
+        size_t busy;                ///< Replicas currently checked out
+        size_t peak_busy;           ///< Largest number of replicas checked out at once
+        uint64 calls;               ///< Number of completed calls
+        uint64 waited;              ///< Calls that had to wait for a free replica
+        double first_replica_mb;    ///< Resident memory added by the first replica in MiB
+        double per_replica_mb;      ///< Mean resident memory added by every further replica in MiB
+    };
+
+    /**
+    * @class DetectorService
+    * @brief A thread-safe pool of detectors loaded from one model.
+    *
+    * The model file is read into memory once. The first replica is loaded from
+    * that buffer, and every further replica is loaded from it again with its
+    * layer weights pointing at those of the first one. How much memory that
+    * saves depends on how OpenCV holds the parsed model, so the resident
+    * memory added by each replica is measured and reported in ServiceStats.
+    * Calls block while every replica is busy.
+    */
+    class DetectorService {
+        std::vector<std::unique_ptr<Detector>> replicas;  ///< The pool of detectors
+        std::vector<cv::dnn::Net> nets;                   ///< Network of every replica
+        std::vector<size_t> idle;                         ///< Indices of the free replicas
+        std::mutex mutex;                                 ///< Guards the free list and the counters
+        std::condition_variable replica_free;             ///< Signals that a replica was returned
+        ServiceStats stats;                               ///< Service counters
+
+        /**
+        * @brief Waits for a free replica and marks it busy.
+        *
+        * @return The index of the checked out replica.
+        */
+        size_t Checkout();
+
+        /**
+        * @brief Returns a replica to the pool.
+        *
+        * @param replica The index returned by Checkout.
+        */
+        void Release(size_t replica);
+
+        public:
+            /**
+            * @brief Constructs an empty service; Load must be called before use.
+            */
+            DetectorService();
+
+            DetectorService(const DetectorService &) = delete;
+            DetectorService &operator=(const DetectorService &) = delete;
+
+            /**
+            * @brief Loads the model into a pool of replicas.
+            *
+            * The resident memory added by every replica is measured and
+            * reported on the console and in Stats.
+            *
+            * @param model_path The path to the ONNX model file.
+            * @param replica_count The number of replicas, at least one.
+            * @param person_only Whether only the person class is decoded.
+            * @param prune_head Whether the output is sliced to the person channels.
+            * @throws std::runtime_error If the model cannot be read or loaded.
+            */
+            void Load(const std::string &model_path, size_t replica_count,
+                      bool person_only = true, bool prune_head = false);
+
+            /**
+            * @brief Runs the forward pass of a frame on a free replica.
+            *
+            * Safe to call from any thread. The outputs are copied out of the
+            * replica before it is returned to the pool.
+            *
+            * @param frame The input image.
+            * @return The raw network outputs, as returned by Detector::PreProcess.
+            */
+            std::vector<cv::Mat> Infer(const cv::Mat &frame);
+
+            /**
+            * @brief Detects the objects of a frame on a free replica.
+            *
+            * Safe to call from any thread. Runs the forward pass and the
+            * postprocessing of Detector on the same replica.
+            *
+            * @param frame The input image.
+            * @param class_ids A pointer to a vector to store detected class IDs.
+            * @param confidences A pointer to a vector to store confidence scores.
+            * @param boxes A pointer to a vector to store bounding boxes.
+            * @param indices A pointer to a vector to store indices of the filtered detections.
+            */
+            void Detect(const cv::Mat &frame, std::vector<int> *class_ids,
+                        std::vector<float> *confidences,
+                        std::vector<cv::Rect> *boxes, std::vector<int> *indices);
+
+            /**
+            * @brief Returns the class names reported by the replicas.
+            */
+            std::vector<std::string> ClassList();
+
+            /**
+            * @brief Returns the counters and memory usage of the service.
+            */
+            ServiceStats Stats();
+
+            /**
+            * @brief Returns the current resident memory of the process in MiB.
+            */
+            static double ResidentMb();
+    };
+
+} // namespace TrackAI
+
+#endif  // __DETECTOR_SERVICE_H__
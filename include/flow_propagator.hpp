@@ -0,0 +1,110 @@
+/**
+ * @file flow_propagator.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the FlowPropagator class for
+ *        propagating bounding boxes between detector keyframes.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the FlowPropagator class, which moves and scales bounding
+ * boxes from one frame to the next using sparse pyramidal Lucas-Kanade optical
+ * flow on a small set of feature points inside every box.
+ */
+
+#ifndef __FLOW_PROPAGATOR_H__
+#define __FLOW_PROPAGATOR_H__
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace TrackAI {
+
+    /**
+    * @class FlowPropagator
+    * @brief A class for propagating bounding boxes with sparse optical flow.
+    *
+    * The image pyramid is built once per frame and shared by all targets, and
+    * the feature points of every target are tracked in a single batched call.
+    * Each box is moved by the median displacement and scaled by the median
+    * change of pairwise point distances of the points that pass a
+    * forward-backward consistency check. The fraction of such points is
+    * reported as a per-target quality score.
+    */
+    class FlowPropagator {
+        cv::Size win_size;           ///< Search window of the Lucas-Kanade tracker
+        int max_level;               ///< Number of pyramid levels above the base image
+        int max_points;              ///< Maximum number of feature points per box
+        float fb_threshold;          ///< Maximum forward-backward error in pixels
+        double last_propagate_ms;    ///< Time spent in the last Propagate call in milliseconds
+
+        std::vector<cv::Mat> prev_pyramid;   ///< Pyramid of the previous frame
+        std::vector<cv::Mat> next_pyramid;   ///< Pyramid of the current frame
+        std::vector<cv::Rect> boxes;         ///< Current box of every target
+        std::vector<float> quality;          ///< Quality of every target in [0, 1]
+
+        // Scratch buffers reused across frames to avoid reallocation.
+        std::vector<cv::Point2f> prev_points;    ///< Feature points of all targets in the previous frame
+        std::vector<cv::Point2f> next_points;    ///< Forward-tracked feature points
+        std::vector<cv::Point2f> back_points;    ///< Backward-tracked feature points
+        std::vector<int> point_offsets;          ///< First point of every target, plus an end marker
+        std::vector<uchar> status;               ///< Forward tracking status of every point
+        std::vector<uchar> back_status;          ///< Backward tracking status of every point
+        std::vector<float> error;                ///< Tracking error of every point
+
+        /**
+        * @brief Selects the feature points of every target in a grayscale frame.
+        *
+        * @param gray The grayscale frame.
+        */
+        void SeedPoints(const cv::Mat &gray);
+
+        public:
+            /**
+            * @brief Constructs a FlowPropagator with default tracking parameters.
+            */
+            FlowPropagator();
+
+            /**
+            * @brief Starts propagating the given boxes from a keyframe.
+            *
+            * @param frame The frame the boxes were detected in.
+            * @param bboxes The bounding boxes of the targets.
+            */
+            void Init(const cv::Mat &frame, const std::vector<cv::Rect> &bboxes);
+
+            /**
+            * @brief Propagates every box to a new frame.
+            *
+            * Targets with too few consistent points keep their previous box and
+            * get a quality of zero.
+            *
+            * @param frame The new frame.
+            * @return The propagated bounding box of every target.
+            */
+            const std::vector<cv::Rect>& Propagate(const cv::Mat &frame);
+
+            /**
+            * @brief Returns the quality score of every target in [0, 1].
+            *
+            * The score is the fraction of feature points of a target that passed
+            * the forward-backward check in the last propagation. A low score
+            * means the box should be refreshed by the detector.
+            */
+            const std::vector<float>& Quality() const;
+
+            /**
+            * @brief Returns the current bounding box of every target.
+            */
+            const std::vector<cv::Rect>& Boxes() const;
+
+            /**
+            * @brief Returns the time spent in the last Propagate call in milliseconds.
+            */
+            double LastPropagateMs() const;
+    };
+
+} // namespace TrackAI
+
+#endif  // __FLOW_PROPAGATOR_H__
@@ -0,0 +1,142 @@
+/**
+ * @file frame_grabber.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the FrameGrabber class, a dedicated
+ *        capture thread that always keeps the most recent camera frame.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the FrameGrabber class, which continuously pulls frames from
+ * the camera on its own thread so that the driver never queues stale frames, and
+ * hands the freshest frame, with its capture timestamp, to the processing loop.
+ */
+
+#ifndef __FRAME_GRABBER_H__
+#define __FRAME_GRABBER_H__
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <opencv2/videoio.hpp>
+#include <thread>
+#include "frame_pool.hpp"
+
+namespace TrackAI {
+
+    /**
+    * @struct StampedFrame
+    * @brief A captured frame together with its capture time.
+    */
+    struct StampedFrame {
+        cv::Mat image;                                    ///< The captured image
+        uint64 sequence;                                  ///< Capture sequence number, starting at 0
+        std::chrono::steady_clock::time_point captured;   ///< Monotonic time the frame was read
+    };
+
+    /**
+    * @struct GrabberStats
+    * @brief Capture counters and frame age statistics of a FrameGrabber.
+    */
+    struct GrabberStats {
+        uint64 captured;      ///< Frames read from the camera
+        uint64 delivered;     ///< Frames handed to the processing loop
+        uint64 dropped;       ///< Frames replaced by a newer one, or skipped for lack of a buffer
+        uint64 results;       ///< Frames whose result age was reported
+        uint64 reallocated;   ///< Frames the camera read into a new buffer instead of the pooled one
+        double last_age_ms;   ///< Capture-to-result age of the last reported frame
+        double mean_age_ms;   ///< Mean capture-to-result age
+        double max_age_ms;    ///< Largest capture-to-result age
+    };
+
+    /**
+    * @class FrameGrabber
+    * @brief A latest-frame-wins capture thread.
+    *
+    * The capture thread reads frames into buffers of a FramePool as fast as the
+    * camera delivers them and keeps only the newest one. Processing always
+    * starts on the freshest frame; frames that were never picked up are counted
+    * as dropped. Frames the camera read into a buffer of its own, bypassing
+    * the pool, are counted as reallocated.
+    */
+    class FrameGrabber {
+        cv::VideoCapture capture;              ///< The camera
+        std::unique_ptr<FramePool> pool;       ///< Capture buffers, sized after the first frame
+        std::thread worker;                    ///< The capture thread
+        std::mutex mutex;                      ///< Guards the latest frame and the statistics
+        std::condition_variable frame_ready;   ///< Signals that a new frame or the end arrived
+        StampedFrame latest;                   ///< Newest captured frame not yet delivered
+        bool has_latest;                       ///< Whether latest holds an undelivered frame
+        bool running;                          ///< Cleared to stop the capture thread
+        bool finished;                         ///< Set when the camera stops delivering frames
+        GrabberStats stats;                    ///< Capture counters
+
+        /**
+        * @brief Body of the capture thread.
+        */
+        void CaptureLoop();
+
+        public:
+            /**
+            * @brief Number of capture buffers.
+            *
+            * One frame being captured, one waiting, and up to three held by the
+            * processing loop.
+            */
+            static const size_t kPoolSize = 5;
+
+            /**
+            * @brief Constructs an idle FrameGrabber.
+            */
+            FrameGrabber();
+
+            /**
+            * @brief Stops the capture thread and releases the camera.
+            */
+            ~FrameGrabber();
+
+            /**
+            * @brief Opens a camera and starts the capture thread.
+            *
+            * @param device The index of the camera.
+            * @return False if the camera could not be opened or read.
+            */
+            bool Open(int device);
+
+            /**
+            * @brief Stops the capture thread and releases the camera.
+            */
+            void Close();
+
+            /**
+            * @brief Waits for a frame newer than the last delivered one.
+            *
+            * @param frame Receives the freshest frame.
+            * @return False once the camera stopped delivering frames.
+            */
+            bool Next(StampedFrame *frame);
+
+            /**
+            * @brief Records that the result of a frame is available.
+            *
+            * @param frame The frame whose processing finished.
+            * @return The capture-to-result age of the frame in milliseconds.
+            */
+            double ReportResult(const StampedFrame &frame);
+
+            /**
+            * @brief Returns the capture counters and frame age statistics.
+            */
+            GrabberStats Stats();
+
+            /**
+            * @brief Returns the utilization counters of the capture buffer pool.
+            */
+            PoolStats PoolUsage();
+    };
+
+} // namespace TrackAI
+
+#endif  // __FRAME_GRABBER_H__
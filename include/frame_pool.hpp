@@ -0,0 +1,112 @@
+/**
+ * @file frame_pool.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the FramePool class, a fixed pool
+ *        of pre-allocated frame buffers for the capture loop.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the FramePool class, which hands out pre-sized frame buffers
+ * and recycles them once every downstream stage has released its reference, so
+ * that steady-state capture does not allocate.
+ */
+
+#ifndef __FRAME_POOL_H__
+#define __FRAME_POOL_H__
+#pragma once
+
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace TrackAI {
+
+    /**
+    * @enum PoolPolicy
+    * @brief What FramePool::Acquire does when every buffer is in use.
+    */
+    enum class PoolPolicy {
+        DROP,   ///< Fail immediately so the caller drops the frame
+        BLOCK   ///< Wait for a buffer to be released, up to a timeout, then drop
+    };
+
+    /**
+    * @struct PoolStats
+    * @brief Utilization counters of a FramePool.
+    */
+    struct PoolStats {
+        size_t capacity;      ///< Number of buffers in the pool
+        size_t in_use;        ///< Buffers currently referenced outside the pool
+        size_t peak_in_use;   ///< Largest number of buffers in use at an acquisition
+        uint64 acquired;      ///< Number of successful acquisitions
+        uint64 dropped;       ///< Number of acquisitions that failed because the pool was exhausted
+        uint64 waited;        ///< Number of acquisitions that had to wait for a buffer
+    };
+
+    /**
+    * @class FramePool
+    * @brief A fixed pool of pre-allocated, reference-counted frame buffers.
+    *
+    * Buffers are plain cv::Mat objects, so every downstream copy of a frame
+    * header keeps its buffer alive through OpenCV's own reference count. A
+    * buffer returns to the pool as soon as the pool holds the only reference.
+    * Writing a captured image into an acquired buffer of the same size and type
+    * reuses its memory instead of allocating.
+    */
+    class FramePool {
+        std::vector<cv::Mat> buffers;   ///< The pre-allocated buffers
+        PoolPolicy policy;              ///< Behavior when the pool is exhausted
+        double block_timeout_ms;        ///< Longest wait of the BLOCK policy in milliseconds
+        size_t next;                    ///< Buffer where the next search starts
+        PoolStats stats;                ///< Utilization counters
+        mutable std::mutex mutex;       ///< Guards the search position and the counters
+
+        /**
+        * @brief Returns the number of buffers referenced outside the pool.
+        *        Requires the mutex.
+        */
+        size_t CountInUse() const;
+
+        public:
+            /**
+            * @brief Constructs a pool of pre-allocated buffers.
+            *
+            * @param capacity The number of buffers.
+            * @param size The size of every buffer.
+            * @param type The OpenCV type of every buffer, e.g. CV_8UC3.
+            * @param policy What to do when every buffer is in use.
+            * @param block_timeout_ms The longest wait of the BLOCK policy.
+            */
+            FramePool(size_t capacity, cv::Size size, int type,
+                      PoolPolicy policy = PoolPolicy::DROP,
+                      double block_timeout_ms = 100.0);
+
+            /**
+            * @brief Hands out a free buffer.
+            *
+            * @param frame Receives a header sharing the buffer memory.
+            * @return False if the pool is exhausted and the frame must be dropped.
+            */
+            bool Acquire(cv::Mat *frame);
+
+            /**
+            * @brief Returns whether a frame still uses the memory of a pool buffer.
+            *
+            * A capture into a buffer of a different size or type reallocates the
+            * frame, which then no longer belongs to the pool.
+            *
+            * @param frame The frame to check.
+            * @return True if the frame data lies in one of the buffers.
+            */
+            bool Owns(const cv::Mat &frame) const;
+
+            /**
+            * @brief Returns the utilization counters of the pool.
+            */
+            PoolStats Stats() const;
+    };
+
+} // namespace TrackAI
+
+#endif  // __FRAME_POOL_H__
@@ -0,0 +1,147 @@
+/**
+ * @file latency_monitor.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the LatencyMonitor class, which attributes
+ *        the age of every result to the stages of the pipeline.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the stage timestamps a frame collects on its way from the
+ * camera to its robot-frame result, and the LatencyMonitor class, which keeps
+ * the end-to-end age and per-stage durations of the most recent frames and
+ * summarizes them as percentiles at runtime.
+ */
+
+#ifndef __LATENCY_MONITOR_H__
+#define __LATENCY_MONITOR_H__
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "results_log.hpp"
+
+namespace TrackAI {
+
+    /**
+    * @struct FrameStamps
+    * @brief Monotonic timestamps of one frame at every stage boundary.
+    *
+    * The stages are: waiting for the detector (captured to started), the
+    * forward pass (started to inferred), decoding and non-maximum suppression
+    * (inferred to decoded), and tracking, display and the robot frame
+    * transform (decoded to emitted). With asynchronous inference, the forward
+    * pass lasts from submission until the inference thread finished it, so
+    * the time a result waits to be collected counts as decoding.
+    */
+    struct FrameStamps {
+        uint64_t sequence;                                ///< Capture sequence number of the frame
+        std::chrono::steady_clock::time_point captured;   ///< The frame was read from the camera
+        std::chrono::steady_clock::time_point started;    ///< Detection started on the frame
+        std::chrono::steady_clock::time_point inferred;   ///< The network outputs were collected
+        std::chrono::steady_clock::time_point decoded;    ///< The boxes were decoded and suppressed
+        std::chrono::steady_clock::time_point emitted;    ///< The robot frame positions were computed
+    };
+
+    /**
+    * @struct LatencySummary
+    * @brief Distribution of the latency of the frames in the rolling window.
+    */
+    struct LatencySummary {
+        uint64_t frames;      ///< Frames added since the start
+        size_t window;        ///< Frames in the rolling window
+        double p50_ms;        ///< Median end-to-end age
+        double p90_ms;        ///< 90th percentile of the end-to-end age
+        double p99_ms;        ///< 99th percentile of the end-to-end age
+        double max_ms;        ///< Largest end-to-end age
+        double wait_ms;       ///< Mean time from capture to the start of detection
+        double inference_ms;  ///< Mean duration of the forward pass
+        double decode_ms;     ///< Mean duration of decoding and suppression
+        double track_ms;      ///< Mean duration from decoding to the robot frame result
+    };
+
+    /**
+    * @class LatencyMonitor
+    * @brief Rolling percentiles of the capture-to-result age of the frames.
+    *
+    * The durations of the last window frames are kept in a ring, so adding a
+    * frame is constant time and does not allocate. Summary copies and sorts
+    * the window, which is cheap at the default size. Frames may be added and
+    * summarized from different threads.
+    */
+    class LatencyMonitor {
+        mutable std::mutex mutex;        ///< Guards the ring
+        size_t capacity;                 ///< Size of the rolling window
+        size_t next;                     ///< Ring position of the next frame
+        uint64_t frames;                 ///< Frames added since the start
+        std::vector<double> ages_ms;     ///< End-to-end age of every frame in the window
+        std::vector<double> stages_ms;   ///< Four stage durations of every frame in the window
+
+        public:
+            /**
+            * @brief Default size of the rolling window, 10 s at 30 frames per second.
+            */
+            static const size_t kDefaultWindow = 300;
+
+            /**
+            * @brief Constructs an empty monitor.
+            *
+            * @param window The number of most recent frames summarized.
+            */
+            explicit LatencyMonitor(size_t window = kDefaultWindow);
+
+            /**
+            * @brief Records the timestamps of a finished frame.
+            *
+            * @param stamps The timestamps of the frame, up to emitted.
+            * @return The end-to-end age of the frame in milliseconds.
+            */
+            double Add(const FrameStamps &stamps);
+
+            /**
+            * @brief Summarizes the frames in the rolling window.
+            */
+            LatencySummary Summary() const;
+
+            /**
+            * @brief Forgets every frame.
+            */
+            void Reset();
+
+            /**
+            * @brief Starts the timestamps of a frame at its capture.
+            *
+            * Every later stamp is set to the capture time, so stages that a
+            * caller skips, e.g. a forward pass run elsewhere, count as zero.
+            *
+            * @param sequence The capture sequence number of the frame.
+            * @param captured The time the frame was read from the camera.
+            * @return The timestamps of the frame.
+            */
+            static FrameStamps Begin(uint64_t sequence,
+                                     std::chrono::steady_clock::time_point captured);
+
+            /**
+            * @brief Stores the stage durations of a frame in a detection record.
+            *
+            * @param stamps The timestamps of the frame, up to emitted.
+            * @param record The record to fill in.
+            */
+            static void Encode(const FrameStamps &stamps, DetectionRecord *record);
+
+            /**
+            * @brief Returns the time between two stamps in milliseconds.
+            *
+            * @param from The earlier stamp.
+            * @param to The later stamp.
+            * @return The elapsed time, or zero if the stamps are out of order.
+            */
+            static double Ms(std::chrono::steady_clock::time_point from,
+                             std::chrono::steady_clock::time_point to);
+    };
+
+} // namespace TrackAI
+
+#endif  // __LATENCY_MONITOR_H__
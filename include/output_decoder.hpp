@@ -0,0 +1,211 @@
+/**
+ * @file output_decoder.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the compile-time specialized decoders of YOLO network outputs.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the decoders turning a raw YOLO output tensor into
+ * candidate boxes, class IDs and confidences. A decoder is instantiated per
+ * output layout, class count and person-only flag, so the class loop has a
+ * constant trip count and the person-only decoders read a single score row.
+ * The matching instantiation is selected once from the shape of the output.
+ */
+
+#ifndef __OUTPUT_DECODER_H__
+#define __OUTPUT_DECODER_H__
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace TrackAI {
+
+    /**
+    * @enum OutputLayout
+    * @brief Memory layout of the output tensor of a YOLO model.
+    */
+    enum class OutputLayout {
+        YOLOV5,  ///< 1 x anchors x (5 + classes): box, objectness, class scores per anchor
+        YOLOV8   ///< 1 x (4 + classes) x anchors: one row per box coordinate and class
+    };
+
+    /**
+    * @struct OutputFormat
+    * @brief Shape of the output tensor of a YOLO model.
+    */
+    struct OutputFormat {
+        OutputLayout layout;  ///< Memory layout of the output
+        int anchors;          ///< Number of candidate boxes
+        int classes;          ///< Number of class scores per candidate
+    };
+
+    /**
+    * @struct DecoderParams
+    * @brief Runtime parameters of a decoder call.
+    */
+    struct DecoderParams {
+        int anchors;            ///< Number of candidate boxes in the output
+        int classes;            ///< Number of class scores per candidate
+        float x_factor;         ///< Horizontal scale from the network input to the image
+        float y_factor;         ///< Vertical scale from the network input to the image
+        float score_threshold;  ///< Minimum confidence of a kept candidate
+    };
+
+    /**
+    * @brief Signature shared by every decoder instantiation.
+    *
+    * The candidates whose confidence exceeds the threshold are appended to the
+    * output vectors, with their boxes mapped to image coordinates.
+    */
+    typedef void (*DecodeFunction)(const float *data, const DecoderParams &params,
+                                   std::vector<int> *class_ids,
+                                   std::vector<float> *confidences,
+                                   std::vector<cv::Rect> *boxes);
+
+    /**
+    * @brief Appends one candidate box given in network input coordinates.
+    */
+    inline void EmitCandidate(float cx, float cy, float w, float h, int class_id,
+                              float confidence, const DecoderParams &params,
+                              std::vector<int> *class_ids,
+                              std::vector<float> *confidences,
+                              std::vector<cv::Rect> *boxes) {
+        int left = static_cast<int>((cx - 0.5f * w) * params.x_factor);
+        int top = static_cast<int>((cy - 0.5f * h) * params.y_factor);
+        int width = static_cast<int>(w * params.x_factor);
+        int height = static_cast<int>(h * params.y_factor);
+        class_ids->push_back(class_id);
+        confidences->push_back(confidence);
+        boxes->push_back(cv::Rect(left, top, width, height));
+    }
+
+    /**
+    * @class OutputDecoder
+    * @brief Decoder of one output layout.
+    *
+    * @tparam Layout The memory layout of the output.
+    * @tparam Classes The number of class scores, or 0 to take it from the
+    *                 runtime parameters.
+    * @tparam PersonOnly Whether only class 0 is decoded.
+    */
+    template <OutputLayout Layout, int Classes, bool PersonOnly>
+    struct OutputDecoder;
+
+    /**
+    * @brief Decoder of the channel-major YOLOv8 layout.
+    *
+    * Every row of the output is contiguous over the anchors, so the scores are
+    * scanned row by row and the box rows are only read for kept candidates.
+    */
+    template <int Classes, bool PersonOnly>
+    struct OutputDecoder<OutputLayout::YOLOV8, Classes, PersonOnly> {
+        static void Decode(const float *data, const DecoderParams &params,
+                           std::vector<int> *class_ids,
+                           std::vector<float> *confidences,
+                           std::vector<cv::Rect> *boxes) {
+            const int anchors = params.anchors;
+            const int classes = Classes > 0 ? Classes : params.classes;
+            const int scored = PersonOnly ? 1 : classes;
+            const float *scores = data + 4 * anchors;
+
+            // Best score and class of every anchor, built one class row at a time.
+            static thread_local std::vector<float> best_score;
+            static thread_local std::vector<int> best_class;
+            const float *best = scores;
+            if (scored > 1) {
+                best_score.assign(scores, scores + anchors);
+                best_class.assign(anchors, 0);
+                for (int c = 1; c < scored; ++c) {
+                    const float *row = scores + c * anchors;
+                    for (int i = 0; i < anchors; ++i) {
+                        if (row[i] > best_score[i]) {
+                            best_score[i] = row[i];
+                            best_class[i] = c;
+                        }
+                    }
+                }
+                best = best_score.data();
+            }
+
+            for (int i = 0; i < anchors; ++i) {
+                if (best[i] > params.score_threshold) {
+                    EmitCandidate(data[i], data[anchors + i],
+                                  data[2 * anchors + i], data[3 * anchors + i],
+                                  scored > 1 ? best_class[i] : 0, best[i],
+                                  params, class_ids, confidences, boxes);
+                }
+            }
+        }
+    };
+
+    /**
+    * @brief Decoder of the anchor-major YOLOv5 layout.
+    *
+    * The confidence of a candidate is its objectness times its class score, so
+    * candidates whose objectness is below the threshold are skipped without
+    * reading their class scores.
+    */
+    template <int Classes, bool PersonOnly>
+    struct OutputDecoder<OutputLayout::YOLOV5, Classes, PersonOnly> {
+        static void Decode(const float *data, const DecoderParams &params,
+                           std::vector<int> *class_ids,
+                           std::vector<float> *confidences,
+                           std::vector<cv::Rect> *boxes) {
+            const int classes = Classes > 0 ? Classes : params.classes;
+            const int scored = PersonOnly ? 1 : classes;
+            const int stride = 5 + classes;
+
+            for (int i = 0; i < params.anchors; ++i, data += stride) {
+                const float objectness = data[4];
+                if (objectness <= params.score_threshold) continue;
+
+                const float *scores = data + 5;
+                int class_id = 0;
+                float class_score = scores[0];
+                for (int c = 1; c < scored; ++c) {
+                    if (scores[c] > class_score) {
+                        class_score = scores[c];
+                        class_id = c;
+                    }
+                }
+
+                const float confidence = objectness * class_score;
+                if (confidence > params.score_threshold) {
+                    EmitCandidate(data[0], data[1], data[2], data[3], class_id,
+                                  confidence, params, class_ids, confidences,
+                                  boxes);
+                }
+            }
+        }
+    };
+
+    /**
+    * @brief Describes the output tensor of a YOLO model from its shape.
+    *
+    * A 1 x C x N output with fewer rows than columns is read as the YOLOv8
+    * layout with C - 4 classes, a 1 x N x C output as the YOLOv5 layout with
+    * C - 5 classes.
+    *
+    * @param output The first output tensor of the model.
+    * @param format Output receiving the layout, anchor and class counts.
+    * @return True if the shape is a supported YOLO output.
+    */
+    bool DescribeOutput(const cv::Mat &output, OutputFormat *format);
+
+    /**
+    * @brief Selects the decoder instantiation for an output format.
+    *
+    * The 80-class COCO and single-class outputs get fixed-size decoders, any
+    * other class count a decoder taking the count at runtime.
+    *
+    * @param format The format of the output.
+    * @param person_only Whether only class 0 is decoded.
+    * @return The decoder to call on every output of this format.
+    */
+    DecodeFunction SelectDecoder(const OutputFormat &format, bool person_only);
+
+} // namespace TrackAI
+
+#endif  // __OUTPUT_DECODER_H__
@@ -0,0 +1,167 @@
+/**
+ * @file recorder.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the Recorder class, which records
+ *        visualized frames into segmented Motion-JPEG AVI files.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the Recorder class, which encodes frames to JPEG on a pool
+ * of worker threads while the pipeline keeps running, muxes them in order into
+ * fixed-duration AVI segments, and finalizes every segment as soon as it is full.
+ */
+
+#ifndef __RECORDER_H__
+#define __RECORDER_H__
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+#include "avi_writer.hpp"
+
+namespace TrackAI {
+
+    /**
+    * @struct RecorderStats
+    * @brief Throughput and backlog counters of a Recorder.
+    */
+    struct RecorderStats {
+        uint64 pushed;           ///< Frames accepted for recording
+        uint64 dropped;          ///< Frames rejected because the backlog was full
+        uint64 encoded;          ///< Frames encoded to JPEG
+        uint64 written;          ///< Frames written to a segment
+        size_t backlog;          ///< Frames accepted but not written yet
+        int segments;            ///< Segments opened so far
+        double encode_fps;       ///< Encoded frames per second since the first frame
+        double mean_encode_ms;   ///< Mean time to encode one frame on one worker
+        double segment_fps;      ///< Measured frame rate of the last finalized segment
+    };
+
+    /**
+    * @class Recorder
+    * @brief A segmented, parallel-encoding Motion-JPEG recorder.
+    *
+    * Push copies the frame into a bounded queue and returns immediately, so
+    * recording never stalls detection; when the backlog is full the frame is
+    * dropped and counted. Worker threads encode queued frames to JPEG in
+    * parallel and a muxer thread writes them in submission order. The output
+    * is rotated into segments of a fixed duration, each finalized with the
+    * frame rate measured from the frame timestamps.
+    */
+    class Recorder {
+        /**
+        * @struct Job
+        * @brief A frame waiting to be encoded.
+        */
+        struct Job {
+            uint64 sequence;     ///< Position of the frame in the recording
+            cv::Mat image;       ///< Copy of the frame
+            double timestamp;    ///< Time the frame was pushed, in seconds
+        };
+
+        /**
+        * @struct Encoded
+        * @brief A frame waiting to be muxed.
+        */
+        struct Encoded {
+            std::vector<uchar> jpeg;   ///< The JPEG-encoded frame
+            double timestamp;          ///< Time the frame was pushed, in seconds
+        };
+
+        std::string prefix;          ///< Path prefix of the segment files
+        double segment_seconds;      ///< Duration of one segment in seconds
+        int worker_count;            ///< Number of encoder threads
+        size_t max_backlog;          ///< Largest number of frames accepted but not written
+
+        std::deque<Job> jobs;                  ///< Frames waiting for an encoder
+        std::map<uint64, Encoded> encoded;     ///< Encoded frames waiting for their turn
+        std::vector<std::thread> encoders;     ///< The encoder threads
+        std::thread muxer;                     ///< The muxer thread
+        std::mutex mutex;                      ///< Guards the queues and the statistics
+        std::condition_variable job_ready;     ///< Signals encoders that a job was queued
+        std::condition_variable frame_encoded; ///< Signals the muxer that a frame was encoded
+        bool started;                          ///< Whether the threads are running
+        bool closing;                          ///< Set by Close to drain and stop the threads
+        uint64 next_sequence;                  ///< Sequence of the next accepted frame
+        uint64 next_to_write;                  ///< Sequence of the next frame to mux
+        cv::Size frame_size;                   ///< Size of the recorded frames
+        int64 start_tick;                      ///< Tick count of the first accepted frame
+        double total_encode_ms;                ///< Sum of the encode times of all frames
+
+        AviWriter writer;                      ///< Writer of the current segment
+        double segment_start;                  ///< Timestamp of the first frame of the segment
+        double segment_last;                   ///< Timestamp of the last frame of the segment
+        std::vector<std::string> segment_paths;  ///< Paths of all segments
+        RecorderStats stats;                   ///< Throughput and backlog counters
+
+        void EncodeLoop();
+        void MuxLoop();
+        void FinishSegment();
+
+        public:
+            /**
+            * @brief Constructs a Recorder.
+            *
+            * @param prefix Path prefix of the segments, "_NNN.avi" is appended.
+            * @param segment_seconds Duration of one segment in seconds.
+            * @param workers Number of encoder threads, 0 for one per core.
+            * @param max_backlog Largest number of frames waiting to be written.
+            */
+            explicit Recorder(const std::string &prefix = "Results/output",
+                              double segment_seconds = 60.0, int workers = 0,
+                              size_t max_backlog = 64);
+
+            /**
+            * @brief Drains the backlog and finalizes the last segment.
+            */
+            ~Recorder();
+
+            Recorder(const Recorder &) = delete;
+            Recorder &operator=(const Recorder &) = delete;
+
+            /**
+            * @brief Queues a frame for recording, timestamped now.
+            *
+            * @param frame The frame to record. It is copied.
+            * @return False if the backlog was full and the frame was dropped.
+            */
+            bool Push(const cv::Mat &frame);
+
+            /**
+            * @brief Queues a frame for recording with an explicit timestamp.
+            *
+            * @param frame The frame to record. It is copied.
+            * @param timestamp The capture time of the frame in seconds.
+            * @return False if the backlog was full and the frame was dropped.
+            */
+            bool Push(const cv::Mat &frame, double timestamp);
+
+            /**
+            * @brief Writes every accepted frame and finalizes the last segment.
+            *
+            * The Recorder can be pushed to again afterwards; it then starts a new
+            * segment.
+            */
+            void Close();
+
+            /**
+            * @brief Returns the throughput and backlog counters.
+            */
+            RecorderStats Stats();
+
+            /**
+            * @brief Returns the paths of all segments written so far.
+            */
+            std::vector<std::string> Segments();
+    };
+
+} // namespace TrackAI
+
+#endif  // __RECORDER_H__
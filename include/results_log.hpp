@@ -0,0 +1,241 @@
+/**
+ * @file results_log.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the binary results log, its writer
+ *        and its memory-mapped reader.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the on-disk format of the append-only results log, which
+ * stores one fixed-width record per detection, together with a per-frame index
+ * file that allows seeking to any frame in constant time.
+ */
+
+#ifndef __RESULTS_LOG_H__
+#define __RESULTS_LOG_H__
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace TrackAI {
+
+    /**
+    * @struct DetectionRecord
+    * @brief One detection of one frame, as stored in the results log.
+    *
+    * The layout is fixed at 64 bytes, little endian, so the log can be memory
+    * mapped and read directly as an array of records.
+    */
+    struct DetectionRecord {
+        uint64_t frame_index;    ///< Index of the frame the detection belongs to
+        int64_t timestamp_ns;    ///< Monotonic time of the frame in nanoseconds
+        float x;                 ///< Left edge of the box in pixels
+        float y;                 ///< Top edge of the box in pixels
+        float width;             ///< Width of the box in pixels
+        float height;            ///< Height of the box in pixels
+        float confidence;        ///< Detection confidence
+        int32_t class_id;        ///< Class of the detection
+        int32_t track_id;        ///< Track the detection belongs to, -1 if untracked
+        float robot_x;           ///< X coordinate in the robot frame
+        float robot_y;           ///< Y coordinate in the robot frame
+        float robot_z;           ///< Z coordinate in the robot frame
+        uint16_t wait_latency;       ///< Capture to start of detection, in kLatencyUnitUs
+        uint16_t inference_latency;  ///< Forward pass, in kLatencyUnitUs
+        uint16_t decode_latency;     ///< Decoding and suppression of the outputs, in kLatencyUnitUs
+        uint16_t track_latency;      ///< Tracking to robot-frame result, in kLatencyUnitUs
+    };
+
+    /**
+    * @brief Unit of the latency fields of a DetectionRecord in microseconds.
+    *
+    * The fields saturate at 65535 units, about 6.5 s. Logs written before
+    * the fields existed hold zeros there.
+    */
+    const uint32_t kLatencyUnitUs = 100;
+
+    static_assert(sizeof(DetectionRecord) == 64,
+                  "DetectionRecord must stay 64 bytes wide");
+
+    /**
+    * @struct FrameIndexEntry
+    * @brief Location of the records of one frame, as stored in the index file.
+    *
+    * Entry N of the index file describes frame N, so a frame is found by
+    * reading a single entry at a computed offset.
+    */
+    struct FrameIndexEntry {
+        uint64_t first_record;   ///< Position of the first record of the frame
+        uint32_t count;          ///< Number of records of the frame
+        uint32_t reserved;       ///< Reserved, written as zero
+    };
+
+    static_assert(sizeof(FrameIndexEntry) == 16,
+                  "FrameIndexEntry must stay 16 bytes wide");
+
+    /**
+    * @class ResultsLog
+    * @brief Append-only writer of the binary results log.
+    *
+    * Records go through a buffered stream, so appending a frame costs a memory
+    * copy; the data reaches the disk when the buffer fills, on Flush and on
+    * Close. The records and the index are separate streams that fill their
+    * buffers independently, so between flushes the index may reach the disk
+    * ahead of the records, e.g. during a run of empty frames. A log cut short
+    * is made consistent when it is reopened, which drops the index entries
+    * past the last complete record, and readers skip such entries.
+    */
+    class ResultsLog {
+        std::FILE *log_file;       ///< The records file, null when closed
+        std::FILE *index_file;     ///< The frame index file, null when closed
+        uint64_t record_count;     ///< Number of records in the log
+        uint64_t frame_count;      ///< Number of frames in the index
+
+        public:
+            /**
+            * @brief Size of the file header of both the log and the index.
+            */
+            static const size_t kHeaderSize = 64;
+
+            /**
+            * @brief Returns the path of the index file of a log.
+            *
+            * @param path The path of the log.
+            * @return The path of the index file.
+            */
+            static std::string IndexPath(const std::string &path);
+
+            /**
+            * @brief Constructs a closed ResultsLog.
+            */
+            ResultsLog();
+
+            /**
+            * @brief Flushes and closes the log.
+            */
+            ~ResultsLog();
+
+            ResultsLog(const ResultsLog &) = delete;
+            ResultsLog &operator=(const ResultsLog &) = delete;
+
+            /**
+            * @brief Opens a log for appending, creating it if needed.
+            *
+            * @param path The path of the log; the index is written next to it.
+            * @return False if the files could not be opened or are not results logs.
+            */
+            bool Open(const std::string &path);
+
+            /**
+            * @brief Appends the records of one frame.
+            *
+            * Frames must be appended in increasing order; skipped frame indices
+            * get empty index entries so that seeking stays constant time.
+            *
+            * @param frame_index The index of the frame.
+            * @param records The detections of the frame.
+            * @return False if the log is closed, the frame is out of order, or
+            *         the write failed.
+            */
+            bool Append(uint64_t frame_index,
+                        const std::vector<DetectionRecord> &records);
+
+            /**
+            * @brief Pushes buffered records to the operating system.
+            *
+            * The records are flushed before the index, so after Flush the
+            * index only refers to written records.
+            */
+            void Flush();
+
+            /**
+            * @brief Flushes and closes the log.
+            */
+            void Close();
+
+            /**
+            * @brief Returns whether the log is open.
+            */
+            bool IsOpen() const;
+
+            /**
+            * @brief Returns the index of the next frame to append.
+            */
+            uint64_t NextFrame() const;
+    };
+
+    /**
+    * @class ResultsLogReader
+    * @brief Memory-mapped reader of the binary results log.
+    */
+    class ResultsLogReader {
+        void *log_map;                       ///< Mapping of the records file
+        size_t log_size;                     ///< Size of the records mapping
+        void *index_map;                     ///< Mapping of the index file
+        size_t index_size;                   ///< Size of the index mapping
+        const DetectionRecord *records;      ///< First record
+        const FrameIndexEntry *entries;      ///< First index entry
+        uint64_t record_count;               ///< Number of complete records
+        uint64_t frame_count;                ///< Number of complete index entries
+
+        public:
+            /**
+            * @brief Constructs a closed reader.
+            */
+            ResultsLogReader();
+
+            /**
+            * @brief Unmaps the log.
+            */
+            ~ResultsLogReader();
+
+            ResultsLogReader(const ResultsLogReader &) = delete;
+            ResultsLogReader &operator=(const ResultsLogReader &) = delete;
+
+            /**
+            * @brief Maps a log and its index.
+            *
+            * @param path The path of the log.
+            * @return False if the files could not be mapped or are not results logs.
+            */
+            bool Open(const std::string &path);
+
+            /**
+            * @brief Unmaps the log.
+            */
+            void Close();
+
+            /**
+            * @brief Returns the number of records in the log.
+            */
+            uint64_t Records() const;
+
+            /**
+            * @brief Returns the number of indexed frames.
+            */
+            uint64_t Frames() const;
+
+            /**
+            * @brief Returns a record by position.
+            *
+            * @param position The position of the record, below Records().
+            */
+            const DetectionRecord &Record(uint64_t position) const;
+
+            /**
+            * @brief Finds the records of a frame in constant time.
+            *
+            * @param frame_index The index of the frame.
+            * @param count Receives the number of records of the frame.
+            * @return The first record of the frame, or null if the frame has none.
+            */
+            const DetectionRecord *Frame(uint64_t frame_index, uint32_t *count) const;
+    };
+
+} // namespace TrackAI
+
+#endif  // __RESULTS_LOG_H__
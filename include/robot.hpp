@@ -15,11 +15,20 @@
 #define __ROBOT_H__
 #pragma once
 
+#include <chrono>
 #include <iostream>
 #include <opencv2/opencv.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 #include "detector.hpp"
+#include "detector_cascade.hpp"
+#include "frame_grabber.hpp"
+#include "latency_monitor.hpp"
+#include "results_log.hpp"
+#include "roi_refiner.hpp"
+#include "shm_ring.hpp"
+#include "target_predictor.hpp"
+#include "track_store.hpp"
 #include "tracker.hpp"
 #include "visualizer.hpp"
 
@@ -36,6 +45,7 @@ namespace TrackAI {
     */
     class Robot {
         Detector detector;          ///< The object responsible for detecting humans in images
+        Tracker tracker;            ///< The per-target tracker kept across frames
         cv::dnn::Net net;          ///< The DNN model used for detection
         Visualizer visualizer;      ///< The visualizer for displaying results
 
@@ -43,7 +53,43 @@ namespace TrackAI {
         cv::Mat R;                 ///< Rotation matrix
         cv::Mat T;                 ///< Translation vector
 
+        TrackStore track_store;    ///< Image tracks giving every detection a stable identifier
+        TargetPredictor predictor;  ///< Position and velocity of every person in the robot frame
+        ResultsLog results_log;    ///< Binary log of every detection
+        ShmPublisher publisher;    ///< Shares every frame and its detections with local processes
+        uint64_t frame_index;      ///< Index of the next processed frame
+        LatencyMonitor latency;    ///< Capture-to-result age of the recent frames
+
+        RoiRefiner refiner;        ///< Detects the tracked people from crops around them
+        bool refine;               ///< Whether ProcessImage detects through the refiner
+        std::vector<cv::Rect> predicted;  ///< Track boxes predicted to the frame being refined
+        DetectorCascade cascade;   ///< Cheaper HOG-based detection under overload
+        bool cascade_enabled;      ///< Whether the cascade follows the frame latency
+
+        /**
+        * @brief Tracks, displays, logs and publishes the detections of a frame.
+        *
+        * @param frame The image frame the detections belong to.
+        * @param class_ids The class of every candidate.
+        * @param confidences The confidence of every candidate.
+        * @param boxes The box of every candidate in the frame.
+        * @param indices The candidates kept by non-maximum suppression.
+        * @param human A reference to a Mat object for storing human detection data.
+        * @param stamps The timestamps of the frame, up to decoded. Receives
+        *               the emitted stamp.
+        */
+        void ProcessBoxes(cv::Mat &frame, const std::vector<int> &class_ids,
+                          const std::vector<float> &confidences,
+                          const std::vector<cv::Rect> &boxes,
+                          const std::vector<int> &indices, cv::Mat &human,
+                          FrameStamps *stamps);
+
         public:
+            /**
+            * @brief Assumed height of a person in metres, which sets the depth of a box.
+            */
+            static constexpr double kPersonHeight = 1.7;
+
             /**
             * @brief Default constructor for the Robot class.
             *
@@ -75,6 +121,60 @@ namespace TrackAI {
             */
             void Run(bool is_camera = true);
 
+            /**
+            * @brief Loads the detection model without starting the main loop.
+            *
+            * @param model_path The path to the ONNX model file.
+            * @return True if the model was loaded, false if the file does not exist.
+            */
+            bool LoadModel(const std::string &model_path);
+
+            /**
+            * @brief Disables the display window and the video recording.
+            *
+            * @param headless True to run without any window or recording.
+            */
+            void SetHeadless(bool headless);
+
+            /**
+            * @brief Enables detecting the tracked people from crops around them.
+            *
+            * When enabled, ProcessImage runs the RoiRefiner instead of a
+            * full-frame forward pass, around the boxes of the track store
+            * moved along their velocity to the capture time of the frame. The
+            * camera loop then runs synchronously since every frame needs the
+            * tracks of the previous one. The application enables it with the
+            * --refine option.
+            *
+            * @param enabled True to refine the tracked boxes from crops.
+            */
+            void SetRefinement(bool enabled);
+
+            /**
+            * @brief Returns the counters of the region refinement.
+            */
+            RefinerStats RefinementStats() const;
+
+            /**
+            * @brief Enables falling back to HOG-based detection under overload.
+            *
+            * When the capture-to-result latency of the frames stays above the
+            * budget, ProcessImage steps down from the DNN to HOG proposals
+            * verified by the DNN, then to HOG alone, and back up once the
+            * latency recovers. Like refinement, this makes the camera loop
+            * synchronous. The cascade is off by default; the application
+            * enables it with the --overload-budget option.
+            *
+            * @param budget_ms The frame latency budget in milliseconds, zero to
+            *                  always detect with the DNN.
+            */
+            void SetOverloadBudget(double budget_ms);
+
+            /**
+            * @brief Returns the counters of the detector cascade.
+            */
+            CascadeStats OverloadStats() const;
+
             /**
             * @brief Processes a single image for detection and tracking.
             *
@@ -82,20 +182,96 @@ namespace TrackAI {
             * tracking state. The results are stored in the provided detections vector.
             *
             * @param frame The input image frame to be processed.
+            * @param detections A vector to hold the detection results. Left empty
+            *                   when the frame was detected through the refiner.
+            * @param human A reference to a Mat object for storing human detection data.
+            * @param stamps The timestamps of the frame, from its capture on.
+            *               The stages of ProcessImage are stamped here.
+            */
+            void ProcessImage(cv::Mat &frame, std::vector<cv::Mat> &detections, cv::Mat &human,
+                              FrameStamps stamps);
+
+            /**
+            * @brief Processes a single image that did not come from the camera.
+            *
+            * The frame is stamped as captured now, with the index of the next
+            * processed frame as its sequence number, so images read from disk
+            * are numbered like the camera frames.
+            *
+            * @param frame The input image frame to be processed.
             * @param detections A vector to hold the detection results.
             * @param human A reference to a Mat object for storing human detection data.
             */
             void ProcessImage(cv::Mat &frame, std::vector<cv::Mat> &detections, cv::Mat &human);
 
+            /**
+            * @brief Postprocesses, tracks and displays the raw detections of a frame.
+            *
+            * This method performs every step of ProcessImage after the forward
+            * pass, so it can run on the outputs of an asynchronous inference.
+            *
+            * @param frame The image frame the detections belong to.
+            * @param detections The raw network outputs of the frame.
+            * @param human A reference to a Mat object for storing human detection data.
+            * @param stamps The timestamps of the frame, up to inferred. The
+            *               capture time also stamps the measurements fed to
+            *               the target predictor.
+            */
+            void ProcessDetections(cv::Mat &frame, std::vector<cv::Mat> &detections, cv::Mat &human,
+                                   FrameStamps stamps);
+
+            /**
+            * @brief Postprocesses the raw detections of a frame that did not come from the camera.
+            *
+            * The frame is stamped as captured now, with the index of the next
+            * processed frame as its sequence number.
+            *
+            * @param frame The image frame the detections belong to.
+            * @param detections The raw network outputs of the frame.
+            * @param human A reference to a Mat object for storing human detection data.
+            */
+            void ProcessDetections(cv::Mat &frame, std::vector<cv::Mat> &detections, cv::Mat &human);
+
+            /**
+            * @brief Returns the capture-to-result age percentiles of the recent frames.
+            *
+            * Safe to call from another thread while the robot runs.
+            */
+            LatencySummary Latency() const;
+
+            /**
+            * @brief Predicts the position of every tracked person at a given time.
+            *
+            * The controller passes the time its command takes effect, e.g. the
+            * capture time of the last frame plus the known pipeline delay, to
+            * compensate for the age of the measurements. Does not allocate once
+            * the output has enough capacity.
+            *
+            * @param when The time to predict at.
+            * @param targets Output receiving the predicted state of every track.
+            */
+            void PredictTargets(std::chrono::steady_clock::time_point when,
+                                std::vector<PredictedTarget> *targets) const;
+
+            /**
+            * @brief Converts a steady clock time into the seconds used by the predictor.
+            */
+            static double Seconds(std::chrono::steady_clock::time_point time);
+
             /**
             * @brief Transforms detected coordinates into the robot's reference frame.
             *
-            * This method converts the coordinates of detected objects from the 
-            * camera frame to the robot frame for further processing and navigation.
+            * This method back-projects the center of every box through K, at the
+            * depth where the box is kPersonHeight tall, and converts the point
+            * from the camera frame to the robot frame with R and T. The
+            * positions are in metres.
             *
             * @param detections A vector of bounding boxes for detected objects.
+            * @param positions Optional output receiving the robot frame coordinates
+            *                  of every box.
             */
-            void CoorInRobotFrame(const std::vector<cv::Rect> &detections);
+            void CoorInRobotFrame(const std::vector<cv::Rect> &detections,
+                                  std::vector<cv::Point3d> *positions = nullptr);
         };
 
 } // namespace TrackAI
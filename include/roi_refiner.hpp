@@ -0,0 +1,124 @@
+/**
+ * @file roi_refiner.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the RoiRefiner class for track-guided detection.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the RoiRefiner class, which refreshes the boxes of the
+ * tracked people by running the detector on small padded crops around them
+ * instead of the whole frame, with a periodic full-frame pass to pick up
+ * people entering the scene.
+ */
+
+#ifndef __ROI_REFINER_H__
+#define __ROI_REFINER_H__
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+#include <vector>
+#include "detector.hpp"
+
+namespace TrackAI {
+
+    /**
+    * @struct RefinerStats
+    * @brief Counters of the RoiRefiner.
+    */
+    struct RefinerStats {
+        uint64 frames;          ///< Frames detected through the refiner
+        uint64 full_passes;     ///< Frames that ran a full-frame pass
+        uint64 refined;         ///< Frames detected from crops alone
+        uint64 fallbacks;       ///< Refinements that gave way to a full-frame pass
+        uint64 crops;           ///< Crops run through the network
+        double compute_saved;   ///< Fraction of network input pixels saved against full-frame passes only
+    };
+
+    /**
+    * @class RoiRefiner
+    * @brief Detects the tracked people from a batch of low-resolution crops.
+    *
+    * Every tracked box is padded, made square and clipped to the frame;
+    * overlapping crops are merged. The crops go through the network as one
+    * batch at a small input size, so a few people cost a fraction of the
+    * full-frame forward pass. A full-frame pass still runs every few frames,
+    * when nothing is tracked, and as a fallback when there are too many
+    * crops, when the crops lose a tracked person, or when the model does not
+    * accept the crop batch.
+    */
+    class RoiRefiner {
+        int full_interval;         ///< A full-frame pass runs at least every this many frames
+        float padding;             ///< Context added on every side of a box, relative to its size
+        cv::Size region_input;     ///< Network input size of a crop
+        size_t max_regions;        ///< Largest number of crops worth running instead of the full frame
+        bool supported;            ///< Cleared once the model rejects a crop batch
+        int since_full;            ///< Frames since the last full-frame pass
+        double input_pixels;       ///< Network input pixels run so far
+        RefinerStats stats;        ///< Counters reported by Stats
+        std::vector<cv::Rect> regions;  ///< Scratch: crops of the current frame
+
+        public:
+            /**
+            * @brief Network input size of a full frame, as used by Detector::PreProcess.
+            */
+            static const int kFullInput = 640;
+
+            /**
+            * @brief Constructs a refiner.
+            *
+            * @param full_interval A full-frame pass runs at least every this many frames.
+            * @param padding Context added on every side of a box, relative to its size.
+            * @param region_input Network input size of a crop, a multiple of 32.
+            * @param max_regions Largest number of crops run instead of the full frame.
+            */
+            explicit RoiRefiner(int full_interval = 10, float padding = 0.5f,
+                                cv::Size region_input = cv::Size(256, 256),
+                                size_t max_regions = 4);
+
+            /**
+            * @brief Detects the people of a frame, refining the tracked boxes when possible.
+            *
+            * The outputs have the same meaning as those of Detector::PostProcess.
+            *
+            * @param detector The detector, loaded with the model.
+            * @param net The network returned by Detector::Load.
+            * @param frame The frame to detect in.
+            * @param tracks The boxes of the tracked people, predicted for this frame.
+            * @param class_ids A pointer to a vector to store detected class IDs.
+            * @param confidences A pointer to a vector to store confidence scores.
+            * @param boxes A pointer to a vector to store bounding boxes.
+            * @param indices A pointer to a vector to store indices of the filtered detections.
+            * @return True if the frame was detected from crops alone.
+            */
+            bool Detect(Detector &detector, cv::dnn::Net &net, cv::Mat &frame,
+                        const std::vector<cv::Rect> &tracks,
+                        std::vector<int> *class_ids, std::vector<float> *confidences,
+                        std::vector<cv::Rect> *boxes, std::vector<int> *indices);
+
+            /**
+            * @brief Returns the counters of the refiner.
+            */
+            RefinerStats Stats() const;
+
+            /**
+            * @brief Computes the crops covering a set of boxes.
+            *
+            * Every box is grown by the padding on each side, made square around
+            * its center and clipped to the frame. A crop overlapping an earlier
+            * one by more than half of the smaller of the two is merged into it.
+            *
+            * @param tracks The boxes to cover.
+            * @param frame_size The size of the frame.
+            * @param padding Context added on every side of a box, relative to its size.
+            * @param regions Output receiving the crops.
+            */
+            static void PlanRegions(const std::vector<cv::Rect> &tracks,
+                                    cv::Size frame_size, float padding,
+                                    std::vector<cv::Rect> *regions);
+    };
+
+} // namespace TrackAI
+
+#endif  // __ROI_REFINER_H__
@@ -0,0 +1,248 @@
+/**
+ * @file shm_ring.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the shared-memory frame publisher and subscriber.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the ShmPublisher and ShmSubscriber classes, which share
+ * processed frames and their detection records with other local processes
+ * through a POSIX shared-memory ring buffer.
+ *
+ * The segment starts with a 64-byte ring header followed by a fixed number of
+ * slots. Every published frame gets the next sequence number, starting at 1,
+ * and goes to slot sequence % slot_count. A slot holds a 64-byte slot header,
+ * room for max_detections DetectionRecord entries and the image bytes.
+ *
+ * Each slot is guarded by a sequence lock: its counter is odd while the
+ * publisher writes it and equals twice the sequence number once complete.
+ * The publisher never waits for readers. Readers access the frames in place
+ * and check afterwards that the slot was not overwritten in the meantime; a
+ * reader that falls more than slot_count frames behind skips the lost frames.
+ */
+
+#ifndef __SHM_RING_H__
+#define __SHM_RING_H__
+#pragma once
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+#include "results_log.hpp"
+
+namespace TrackAI {
+
+    /**
+    * @struct ShmFrame
+    * @brief A frame of the ring buffer, read in place.
+    *
+    * The image and records point into the shared memory. They are only
+    * guaranteed to be intact if ShmSubscriber::Valid still returns true
+    * after they have been used.
+    */
+    struct ShmFrame {
+        uint64_t sequence;                ///< Sequence number of the frame, starting at 1
+        uint64_t frame_index;             ///< Index of the frame in the pipeline
+        int64_t timestamp_ns;             ///< Capture time on the steady clock in nanoseconds
+        cv::Mat image;                    ///< The image, without copy
+        const DetectionRecord *records;   ///< The detection records of the frame, without copy
+        uint32_t count;                   ///< Number of detection records
+        const void *slot;                 ///< Slot holding the frame, checked by Valid
+    };
+
+    /**
+    * @class ShmPublisher
+    * @brief Writes frames and detections into a shared-memory ring buffer.
+    *
+    * The publisher owns the segment: opening it replaces any stale segment
+    * of the same name, and closing it unlinks the name.
+    */
+    class ShmPublisher {
+        std::string name;          ///< Name of the shared-memory object
+        unsigned char *base;       ///< Start of the mapped segment
+        size_t mapped_bytes;       ///< Size of the mapped segment
+        uint64_t sequence;         ///< Sequence number of the last published frame
+        uint64_t rejected;         ///< Frames that did not fit into a slot
+
+        public:
+            /**
+            * @brief Default ring buffer geometry, sized for 1080p color frames.
+            */
+            static const uint32_t kDefaultSlots = 8;
+            static const size_t kDefaultImageBytes = 1920 * 1080 * 3;
+            static const uint32_t kDefaultDetections = 128;
+
+            /**
+            * @brief Constructs a closed publisher.
+            */
+            ShmPublisher();
+
+            /**
+            * @brief Closes the publisher and unlinks its segment.
+            */
+            ~ShmPublisher();
+
+            ShmPublisher(const ShmPublisher &) = delete;
+            ShmPublisher &operator=(const ShmPublisher &) = delete;
+
+            /**
+            * @brief Creates the shared-memory segment.
+            *
+            * @param segment_name Name of the POSIX shared-memory object, e.g. "/trackai".
+            * @param slot_count Number of frames kept in the ring.
+            * @param max_image_bytes Largest image size in bytes.
+            * @param max_detections Largest number of detection records per frame.
+            * @return True if the segment was created and mapped.
+            */
+            bool Open(const std::string &segment_name,
+                      uint32_t slot_count = kDefaultSlots,
+                      size_t max_image_bytes = kDefaultImageBytes,
+                      uint32_t max_detections = kDefaultDetections);
+
+            /**
+            * @brief Unmaps and unlinks the segment.
+            */
+            void Close();
+
+            /**
+            * @brief Returns whether the segment is open.
+            */
+            bool IsOpen() const;
+
+            /**
+            * @brief Publishes a frame and its detection records.
+            *
+            * Never blocks: the oldest slot is overwritten whether or not every
+            * reader has consumed it.
+            *
+            * @param frame_index Index of the frame in the pipeline.
+            * @param timestamp_ns Capture time on the steady clock in nanoseconds.
+            * @param image The image to publish.
+            * @param records The detection records of the frame.
+            * @return False if the publisher is closed or the frame does not fit.
+            */
+            bool Publish(uint64_t frame_index, int64_t timestamp_ns,
+                         const cv::Mat &image,
+                         const std::vector<DetectionRecord> &records);
+
+            /**
+            * @brief Returns the sequence number of the last published frame.
+            */
+            uint64_t Sequence() const;
+
+            /**
+            * @brief Returns the number of frames that did not fit into a slot.
+            */
+            uint64_t Rejected() const;
+    };
+
+    /**
+    * @class ShmSubscriber
+    * @brief Reads frames and detections from a shared-memory ring buffer.
+    *
+    * Any number of subscribers, in any number of processes, can read the same
+    * segment. Subscribers never write to it.
+    */
+    class ShmSubscriber {
+        const unsigned char *base;   ///< Start of the mapped segment
+        size_t mapped_bytes;         ///< Size of the mapped segment
+        uint64_t next_sequence;      ///< Sequence number of the next frame to read
+        uint64_t dropped;            ///< Frames overwritten before they were read
+
+        /**
+        * @brief Reads the frame with a sequence number into a view.
+        *
+        * @return False if the slot no longer, or not yet, holds that frame.
+        */
+        bool ReadSlot(uint64_t sequence, ShmFrame *frame) const;
+
+        public:
+            /**
+            * @brief Constructs a closed subscriber.
+            */
+            ShmSubscriber();
+
+            /**
+            * @brief Unmaps the segment.
+            */
+            ~ShmSubscriber();
+
+            ShmSubscriber(const ShmSubscriber &) = delete;
+            ShmSubscriber &operator=(const ShmSubscriber &) = delete;
+
+            /**
+            * @brief Maps an existing segment for reading.
+            *
+            * Reading starts with the newest frame published so far.
+            *
+            * @param segment_name Name of the POSIX shared-memory object.
+            * @return True if the segment exists and has the expected format.
+            */
+            bool Open(const std::string &segment_name);
+
+            /**
+            * @brief Unmaps the segment.
+            */
+            void Close();
+
+            /**
+            * @brief Returns whether a segment is mapped.
+            */
+            bool IsOpen() const;
+
+            /**
+            * @brief Returns the next unread frame, in sequence order.
+            *
+            * Frames that were overwritten before being read are skipped and
+            * counted as dropped.
+            *
+            * @param frame Output receiving a view of the frame.
+            * @return False if no new frame has been published.
+            */
+            bool Next(ShmFrame *frame);
+
+            /**
+            * @brief Returns the newest frame, skipping any unread ones.
+            *
+            * @param frame Output receiving a view of the frame.
+            * @return False if no new frame has been published.
+            */
+            bool Latest(ShmFrame *frame);
+
+            /**
+            * @brief Returns whether a frame view has not been overwritten.
+            *
+            * Call after using the view; if it returns false the data read
+            * through the view may be torn and must be discarded.
+            *
+            * @param frame A view returned by Next or Latest.
+            */
+            bool Valid(const ShmFrame &frame) const;
+
+            /**
+            * @brief Copies a frame out of the ring buffer.
+            *
+            * @param frame A view returned by Next or Latest.
+            * @param image Output receiving a copy of the image.
+            * @param records Output receiving a copy of the detection records.
+            * @return False if the frame was overwritten during the copy.
+            */
+            bool Copy(const ShmFrame &frame, cv::Mat *image,
+                      std::vector<DetectionRecord> *records) const;
+
+            /**
+            * @brief Returns the number of frames overwritten before they were read.
+            */
+            uint64_t Dropped() const;
+
+            /**
+            * @brief Returns the sequence number of the newest published frame.
+            */
+            uint64_t Head() const;
+    };
+
+} // namespace TrackAI
+
+#endif  // __SHM_RING_H__
@@ -0,0 +1,175 @@
+/**
+ * @file target_predictor.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the TargetPredictor class for 3D target state estimation.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the TargetPredictor class, which keeps a constant-velocity
+ * Kalman filter per tracked person in the robot frame. The filters are fed
+ * with the positions of every processed frame, stamped with its capture time,
+ * and can predict where every person will be at any later time, so the
+ * controller can compensate for the capture-to-actuation delay.
+ */
+
+#ifndef __TARGET_PREDICTOR_H__
+#define __TARGET_PREDICTOR_H__
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <utility>
+#include <vector>
+
+namespace TrackAI {
+
+    /**
+    * @struct PredictedTarget
+    * @brief Predicted state of one track at a requested time.
+    */
+    struct PredictedTarget {
+        int id;                     ///< Identifier of the track
+        Eigen::Vector3d position;   ///< Predicted position in the robot frame
+        Eigen::Vector3d velocity;   ///< Estimated velocity in the robot frame per second
+    };
+
+    /**
+    * @struct TargetTrack
+    * @brief Kalman filter state of one tracked person.
+    *
+    * The state holds the position followed by the velocity.
+    */
+    struct TargetTrack {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef Eigen::Matrix<double, 6, 1> State;        ///< Position and velocity
+        typedef Eigen::Matrix<double, 6, 6> Covariance;   ///< Covariance of the state
+
+        int id;              ///< Identifier of the track
+        double stamp;        ///< Time of the state in seconds
+        int misses;          ///< Consecutive updates without a matching measurement
+        State state;         ///< Estimated state at the stamp
+        Covariance covariance;  ///< Covariance of the estimated state
+    };
+
+    /**
+    * @class TargetPredictor
+    * @brief Constant-velocity Kalman filters over the 3D positions of people.
+    *
+    * Measurements of a frame are associated with the tracks by nearest
+    * neighbour within a gate around the position predicted for the frame time.
+    * Unmatched measurements start new tracks and tracks missing for too many
+    * frames are dropped. All matrices are fixed size, and the scratch buffers
+    * are kept between calls, so steady-state updates and predictions do not
+    * allocate.
+    */
+    class TargetPredictor {
+        /// Tracks stored with Eigen's aligned allocator, required before C++17.
+        typedef std::vector<TargetTrack, Eigen::aligned_allocator<TargetTrack>> Tracks;
+
+        double acceleration_noise;   ///< Standard deviation of the unmodelled acceleration (m/s^2)
+        double measurement_noise;    ///< Standard deviation of a measured position (m)
+        double gate;                 ///< Largest distance between a track and its measurement (m)
+        int max_misses;              ///< Updates without a measurement before a track is dropped
+        int next_id;                 ///< Identifier given to the next new track
+
+        Tracks tracks;                                    ///< The current tracks
+        std::vector<std::pair<double, int>> candidates;   ///< Scratch: distance and track/measurement pair
+        std::vector<int> track_match;                     ///< Scratch: measurement matched to every track
+        std::vector<int> measurement_match;               ///< Scratch: track matched to every measurement
+        std::vector<int> track_of_id;                     ///< Scratch: track of every identifier, or -1
+
+        /**
+        * @brief Propagates a track to a later time.
+        */
+        void Propagate(TargetTrack *track, double timestamp) const;
+
+        /**
+        * @brief Corrects a propagated track with a measured position.
+        */
+        void Correct(TargetTrack *track, const Eigen::Vector3d &measurement) const;
+
+        public:
+            /**
+            * @brief Constructs a predictor.
+            *
+            * @param acceleration_noise Standard deviation of the unmodelled acceleration in m/s^2.
+            * @param measurement_noise Standard deviation of a measured position in m.
+            * @param gate Largest distance between a track and its measurement in m.
+            * @param max_misses Updates without a measurement before a track is dropped.
+            */
+            explicit TargetPredictor(double acceleration_noise = 2.0,
+                                     double measurement_noise = 0.1,
+                                     double gate = 1.0, int max_misses = 5);
+
+            /**
+            * @brief Feeds the positions measured in one frame.
+            *
+            * @param timestamp Capture time of the frame in seconds.
+            * @param positions Positions of the detected people in the robot frame.
+            * @param ids Optional output receiving the track of every position.
+            */
+            void Update(double timestamp, const std::vector<Eigen::Vector3d> &positions,
+                        std::vector<int> *ids = nullptr);
+
+            /**
+            * @brief Feeds the positions measured in one frame, already associated.
+            *
+            * Every position belongs to the track with the given identifier,
+            * e.g. the image track of the TrackStore, and starts that track if
+            * it does not exist yet. The tracks not seen in the frame coast and
+            * are dropped after max_misses updates, or earlier through Remove.
+            *
+            * @param timestamp Capture time of the frame in seconds.
+            * @param positions Positions of the detected people in the robot frame.
+            * @param ids The non-negative track identifier of every position.
+            */
+            void UpdateTracked(double timestamp,
+                               const std::vector<Eigen::Vector3d> &positions,
+                               const std::vector<int> &ids);
+
+            /**
+            * @brief Drops one track, e.g. when its identifier is released.
+            *
+            * @param id Identifier of the track.
+            * @return False if there is no track with this identifier.
+            */
+            bool Remove(int id);
+
+            /**
+            * @brief Predicts the state of every track at a given time.
+            *
+            * The output is resized to the number of tracks, so once its
+            * capacity is large enough the call does not allocate.
+            *
+            * @param timestamp The time to predict at in seconds, usually the
+            *                  capture time plus the pipeline delay.
+            * @param targets Output receiving one prediction per track.
+            */
+            void PredictAll(double timestamp, std::vector<PredictedTarget> *targets) const;
+
+            /**
+            * @brief Predicts the position of one track at a given time.
+            *
+            * @param id Identifier of the track.
+            * @param timestamp The time to predict at in seconds.
+            * @param position Output receiving the predicted position.
+            * @return False if there is no track with this identifier.
+            */
+            bool Predict(int id, double timestamp, Eigen::Vector3d *position) const;
+
+            /**
+            * @brief Returns the number of tracks.
+            */
+            size_t Size() const;
+
+            /**
+            * @brief Drops every track.
+            */
+            void Clear();
+    };
+
+} // namespace TrackAI
+
+#endif  // __TARGET_PREDICTOR_H__
@@ -0,0 +1,223 @@
+/**
+ * @file track_store.hpp
+ * @author Datta Lohith Gannavarapu, Dheeraj Vishnubhotla, Nazrin Gurbanova
+ * @brief This file contains the declaration of the TrackStore class, the table of tracked people.
+ * @version 0.1
+ * @date 2024-10-23
+ * @copyright Copyright (c) 2024
+ *
+ * This file defines the TrackStore class, which keeps the state of every
+ * tracked person as a struct of arrays and associates the detections of each
+ * frame with it, so that scenes with hundreds of people stay cheap to track.
+ */
+
+#ifndef __TRACK_STORE_H__
+#define __TRACK_STORE_H__
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <utility>
+#include <vector>
+
+namespace TrackAI {
+
+    /**
+    * @class TrackStore
+    * @brief Contiguous struct-of-arrays table of tracks with stable identifiers.
+    *
+    * Every column holds one value per track, packed in slots 0 to Size() - 1,
+    * so the per-frame passes (predict, age, prune) are plain loops over
+    * contiguous floats and integers that the compiler vectorizes. A track is
+    * removed by moving the last slot into its place, and its identifier goes
+    * to a free list from which new tracks take theirs, so insertion and
+    * removal are O(1) and identifiers stay small.
+    *
+    * Detections are associated with the predicted tracks through a uniform
+    * grid of track centers with cells as large as the largest box: two boxes
+    * can only overlap if their centers lie in the same or neighbouring cells,
+    * so only those pairs are scored, by their intersection over union blended
+    * with the similarity of their appearance signatures. The best pairs are
+    * matched greedily.
+    */
+    class TrackStore {
+        public:
+            /**
+            * @brief Number of floats in an appearance signature.
+            */
+            static const int kSignatureSize = 16;
+
+        private:
+            float min_iou;             ///< Smallest overlap of a track and its detection
+            float appearance_weight;   ///< Weight of the appearance in the association score
+            float velocity_gain;       ///< Share of the innovation applied to the velocity
+            int max_misses;            ///< Frames without a detection before a track is removed
+            double stamp;              ///< Time of the last update in seconds, negative before
+
+            // Columns, one entry per track.
+            std::vector<float> cx;           ///< Box center, horizontal (px)
+            std::vector<float> cy;           ///< Box center, vertical (px)
+            std::vector<float> width;        ///< Box width (px)
+            std::vector<float> height;       ///< Box height (px)
+            std::vector<float> vx;           ///< Center velocity, horizontal (px/s)
+            std::vector<float> vy;           ///< Center velocity, vertical (px/s)
+            std::vector<int> age;            ///< Frames since the track was created
+            std::vector<int> misses;         ///< Frames since the track was last detected
+            std::vector<int> ids;            ///< Identifier of the track
+            std::vector<float> signatures;   ///< kSignatureSize floats per track
+
+            // Identifier bookkeeping.
+            std::vector<int> slot_of;        ///< Slot of every identifier, -1 when free
+            std::vector<int> free_ids;       ///< Released identifiers, reused last in first out
+
+            // Scratch buffers reused across frames to avoid reallocation.
+            std::vector<int> cell_start;     ///< First entry of every grid cell in cell_items
+            std::vector<int> cell_items;     ///< Track slots sorted by grid cell
+            std::vector<int> cell_of;        ///< Grid cell of every track slot
+            std::vector<std::pair<float, int>> candidates;  ///< Score and track/detection pair
+            std::vector<int> track_match;    ///< Detection matched to every track slot
+            std::vector<int> detection_match;  ///< Track slot matched to every detection
+
+            /**
+            * @brief Moves the slot of a track to another slot, overwriting it.
+            */
+            void MoveSlot(int from, int to);
+
+        public:
+            /**
+            * @brief Constructs an empty store.
+            *
+            * @param min_iou Smallest overlap of a predicted track and its detection.
+            * @param appearance_weight Weight of the appearance in the association score.
+            * @param max_misses Frames without a detection before a track is removed.
+            * @param velocity_gain Share of the position innovation applied to the velocity.
+            */
+            explicit TrackStore(float min_iou = 0.1f, float appearance_weight = 0.3f,
+                                int max_misses = 5, float velocity_gain = 0.5f);
+
+            /**
+            * @brief Tracks the detections of one frame.
+            *
+            * Predicts every track to the frame time, ages them, associates
+            * the detections, corrects the matched tracks, starts a track for
+            * every unmatched detection and removes the tracks missing for too
+            * many frames.
+            *
+            * @param timestamp Capture time of the frame in seconds.
+            * @param detections The boxes detected in the frame.
+            * @param detection_signatures kSignatureSize floats per detection, or
+            *                             nullptr to associate on overlap alone.
+            * @param detection_ids Output receiving the track identifier of every detection.
+            * @param removed Optional output receiving the identifiers released
+            *                in this frame, which may be reused from the next frame on.
+            */
+            void Update(double timestamp, const std::vector<cv::Rect> &detections,
+                        const float *detection_signatures,
+                        std::vector<int> *detection_ids,
+                        std::vector<int> *removed = nullptr);
+
+            /**
+            * @brief Moves every track along its velocity.
+            *
+            * @param dt The time step in seconds.
+            */
+            void Predict(float dt);
+
+            /**
+            * @brief Ages every track by one frame.
+            */
+            void Age();
+
+            /**
+            * @brief Removes the tracks missing for more than max_misses frames.
+            *
+            * @param removed Optional output receiving the released identifiers.
+            */
+            void Prune(std::vector<int> *removed = nullptr);
+
+            /**
+            * @brief Matches detections with tracks through the spatial grid.
+            *
+            * @param detections The boxes detected in the frame.
+            * @param detection_signatures kSignatureSize floats per detection, or nullptr.
+            * @param matches Output receiving the slot matched to every detection, or -1.
+            */
+            void Associate(const std::vector<cv::Rect> &detections,
+                           const float *detection_signatures,
+                           std::vector<int> *matches);
+
+            /**
+            * @brief Starts a track.
+            *
+            * @param box The box of the track.
+            * @param signature kSignatureSize floats, or nullptr for a flat signature.
+            * @return The identifier of the new track.
+            */
+            int Insert(const cv::Rect &box, const float *signature);
+
+            /**
+            * @brief Removes a track.
+            *
+            * @param id The identifier of the track.
+            * @return False if there is no track with this identifier.
+            */
+            bool Remove(int id);
+
+            /**
+            * @brief Returns the current box of a track.
+            *
+            * @param id The identifier of the track.
+            * @param box Output receiving the box.
+            * @return False if there is no track with this identifier.
+            */
+            bool Box(int id, cv::Rect *box) const;
+
+            /**
+            * @brief Returns the boxes of the current tracks moved along their velocity to a time.
+            *
+            * Only the tracks detected in the last update are returned; the
+            * ones coasting on missed detections are left out. The tracks are
+            * not changed, so the boxes may be predicted for a frame before its
+            * detections update the store.
+            *
+            * @param timestamp Capture time of the frame in seconds.
+            * @param boxes Output receiving one box per current track.
+            */
+            void PredictedBoxes(double timestamp, std::vector<cv::Rect> *boxes) const;
+
+            /**
+            * @brief Returns the number of frames since a track was created.
+            *
+            * @param id The identifier of the track.
+            * @return The age of the track, or -1 if there is no such track.
+            */
+            int Age(int id) const;
+
+            /**
+            * @brief Returns the number of tracks.
+            */
+            size_t Size() const;
+
+            /**
+            * @brief Removes every track and releases every identifier.
+            */
+            void Clear();
+
+            /**
+            * @brief Computes the appearance signature of a box.
+            *
+            * The signature is a hue histogram of the sufficiently saturated
+            * pixels of the box, sampled every other row and column and
+            * normalized to sum to one; a box without color gets a flat
+            * histogram.
+            *
+            * @param frame The BGR frame.
+            * @param box The box to describe.
+            * @param signature Output receiving kSignatureSize floats.
+            */
+            static void ComputeSignature(const cv::Mat &frame, const cv::Rect &box,
+                                         float *signature);
+    };
+
+} // namespace TrackAI
+
+#endif  // __TRACK_STORE_H__
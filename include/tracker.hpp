@@ -6,10 +6,10 @@
  * @date 2024-10-23
  * @copyright Copyright (c) 2024
  *
- * This file defines the Tracker class, which is responsible for tracking objects 
- * in video frames using OpenCV's tracking algorithms. The class provides methods 
- * for initializing the tracker and updating the tracking state based on detected 
- * bounding boxes.
+ * This file defines the Tracker class, which is responsible for tracking objects
+ * in video frames using OpenCV's tracking algorithms. The class holds one tracker
+ * instance per target, updates them in parallel, and can fall back to a cheaper
+ * tracking backend when the per-frame tracking time exceeds its budget.
  */
 
 #ifndef __TRACKER_H__
@@ -19,42 +19,200 @@
 #include <iostream>
 #include <opencv2/opencv.hpp>
 #include <opencv2/tracking.hpp>
+#include <string>
 #include <vector>
+#include "flow_propagator.hpp"
 
 namespace TrackAI {
 
+    /**
+    * @enum TrackerBackend
+    * @brief The tracking algorithms available to the Tracker class.
+    *
+    * Under load the Tracker steps down the chain CSRT, KCF, MOSSE, FLOW, from
+    * the most expensive to the cheapest. MIL costs about as much as CSRT and
+    * is less accurate, so it is never stepped down to; when selected, it
+    * steps down to KCF.
+    */
+    enum class TrackerBackend {
+        CSRT,   ///< Discriminative correlation filter with channel and spatial reliability
+        MIL,    ///< Multiple instance learning tracker, outside the degradation chain
+        KCF,    ///< Kernelized correlation filter
+        MOSSE,  ///< Minimum output sum of squared error correlation filter
+        FLOW    ///< Sparse optical-flow box propagation shared across all targets
+    };
+
     /**
     * @class Tracker
     * @brief A class for tracking objects in video frames.
     *
-    * The Tracker class encapsulates the functionality needed to initialize and 
-    * manage an object tracker. It uses OpenCV's tracking algorithms to maintain 
-    * the position of detected objects across video frames.
+    * The Tracker class encapsulates the functionality needed to initialize and
+    * manage one OpenCV tracker per target. All targets are updated in parallel
+    * across the available cores, and the backend is stepped down to a cheaper
+    * one when tracking repeatedly exceeds the configured per-frame budget.
     */
     class Tracker {
         bool isInitialized;          ///< Flag indicating whether the tracker has been initialized
-        cv::Ptr<cv::Tracker> tracker; ///< Pointer to the OpenCV Tracker object
+        TrackerBackend backend;      ///< The backend used for newly created trackers
+        double budget_ms;            ///< Per-frame tracking budget in milliseconds (0 disables degradation)
+        int over_budget_frames;      ///< Number of consecutive frames that exceeded the budget
+        double last_track_ms;        ///< Time spent in the last Track, Init or Update call in milliseconds
+
+        std::vector<cv::Ptr<cv::Tracker>> trackers;  ///< One OpenCV tracker per target
+        std::vector<cv::Rect> targets;               ///< Current box of every target
+        std::vector<uchar> found;                    ///< Whether each target was found in the last update
+        std::vector<float> quality;                  ///< Quality score of every target in [0, 1]
+        FlowPropagator flow;                         ///< Box propagator used by the FLOW backend
+
+        /**
+        * @brief Moves every target along with its tracker, without timing it.
+        */
+        void Propagate(const cv::Mat& frame);
+
+        /**
+        * @brief Moves the targets to the detections of a frame.
+        *
+        * The targets are updated, matched greedily with the detections by
+        * overlap, and only the detections without a target, or whose target
+        * drifted off them, get a new tracker.
+        */
+        void Follow(const cv::Mat& frame, const std::vector<cv::Rect>& bboxes);
+
+        /**
+        * @brief Charges the time since start against the budget, stepping down when over it.
+        */
+        void Charge(const cv::Mat& frame, int64 start);
 
         public:
             /**
-            * @brief Constructs a Tracker object and initializes the tracker.
+            * @brief Smallest overlap of a tracked box and its detection that keeps its tracker.
+            */
+            static constexpr double kReseedOverlap = 0.5;
+
+            /**
+            * @brief Number of consecutive over-budget frames that trigger a degradation.
+            */
+            static const int kDegradeAfterFrames = 3;
+
+            /**
+            * @brief Constructs a Tracker object using the CSRT backend.
             *
-            * This constructor sets the initial state of the tracker and prepares it 
-            * for object tracking.
+            * This constructor sets the initial state of the tracker and prepares it
+            * for object tracking without a time budget.
             */
             Tracker();
 
+            /**
+            * @brief Constructs a Tracker object with the given backend and budget.
+            *
+            * @param backend The tracking algorithm to use for every target.
+            * @param budget_ms The per-frame tracking budget in milliseconds. A value
+            *                  of zero disables automatic degradation.
+            */
+            explicit Tracker(TrackerBackend backend, double budget_ms = 0.0);
+
             /**
             * @brief Tracks objects in the current frame based on bounding boxes.
             *
-            * This method updates the tracker with the current frame and the 
-            * corresponding bounding boxes. It computes the new positions of the tracked 
-            * objects and updates their locations.
+            * The targets are updated in parallel and then placed on the
+            * detections of the frame, one target per box, so they always
+            * follow the latest detections. A tracker is only created for a
+            * detection without a target, or whose target overlaps it by less
+            * than kReseedOverlap; the others keep their trackers. The time of
+            * the updates and of the new trackers is charged against the
+            * budget. The resulting boxes are drawn on the frame.
             *
             * @param frame The current video frame in which objects are to be tracked.
             * @param bboxes A vector of bounding boxes for the detected objects.
             */
             void Track(cv::Mat& frame, std::vector<cv::Rect> bboxes);
+
+            /**
+            * @brief Creates and initializes one tracker per bounding box.
+            *
+            * @param frame The frame the bounding boxes were detected in.
+            * @param bboxes The bounding boxes of the targets to track.
+            */
+            void Init(const cv::Mat& frame, const std::vector<cv::Rect>& bboxes);
+
+            /**
+            * @brief Updates every target in parallel with a new frame.
+            *
+            * If the update took longer than the budget for several consecutive
+            * frames, the trackers are re-created with the next cheaper backend.
+            *
+            * @param frame The new video frame.
+            * @return The updated bounding box of every target.
+            */
+            std::vector<cv::Rect> Update(const cv::Mat& frame);
+
+            /**
+            * @brief Returns the current bounding box of every target.
+            */
+            const std::vector<cv::Rect>& Targets() const;
+
+            /**
+            * @brief Returns whether each target was found in the last update.
+            */
+            const std::vector<uchar>& Found() const;
+
+            /**
+            * @brief Returns the quality score of every target in [0, 1].
+            *
+            * For the FLOW backend this is the fraction of consistent feature
+            * points; for the appearance backends it is 1 when the target was
+            * found and 0 otherwise. Targets with a low score should be refreshed
+            * by running the detector.
+            */
+            const std::vector<float>& Quality() const;
+
+            /**
+            * @brief Returns the backend used for the current trackers.
+            */
+            TrackerBackend Backend() const;
+
+            /**
+            * @brief Selects the backend used the next time the trackers are initialized.
+            *
+            * @param new_backend The tracking algorithm to use.
+            */
+            void SetBackend(TrackerBackend new_backend);
+
+            /**
+            * @brief Sets the per-frame tracking budget.
+            *
+            * @param new_budget_ms The budget in milliseconds, zero to disable degradation.
+            */
+            void SetBudget(double new_budget_ms);
+
+            /**
+            * @brief Returns the time spent in the last Track, Init or Update call in milliseconds.
+            */
+            double LastTrackMs() const;
+
+            /**
+            * @brief Creates a single OpenCV tracker for the given backend.
+            *
+            * @param backend The tracking algorithm to instantiate.
+            * @return A pointer to the created tracker.
+            */
+            static cv::Ptr<cv::Tracker> Create(TrackerBackend backend);
+
+            /**
+            * @brief Returns the backend the Tracker degrades to from a given one.
+            *
+            * @param backend The current backend.
+            * @return The next cheaper backend, or FLOW for FLOW itself.
+            */
+            static TrackerBackend Cheaper(TrackerBackend backend);
+
+            /**
+            * @brief Returns the human readable name of a backend.
+            *
+            * @param backend The backend to name.
+            * @return The name of the backend.
+            */
+            static std::string BackendName(TrackerBackend backend);
     };
 
 } // namespace TrackAI
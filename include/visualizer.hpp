@@ -19,6 +19,7 @@
 #include <opencv2/core/mat.hpp>
 #include <iostream>
 #include <opencv2/opencv.hpp>
+#include "recorder.hpp"
 
 namespace TrackAI {
 
@@ -32,9 +33,15 @@ namespace TrackAI {
     class Visualizer {
         public:
             /** 
-              * @brief A vector that stores the images to be processed and visualized.
+              * @brief The recorder that encodes the visualized images into video segments.
               */
-            std::vector<cv::Mat> images;
+            Recorder recorder;
+
+            /** 
+              * @brief Skips the display window and the recording when set, for benchmarks
+              *        and unattended runs.
+              */
+            bool headless = false;
 
             /**
               * @brief Displays the results of human detection in the specified image.
@@ -48,6 +55,21 @@ namespace TrackAI {
               */
             void DisplayResults(cv::dnn::Net &net, cv::Mat &human);
 
+            /**
+              * @brief Displays the results of human detection with a given inference time.
+              *
+              * This overload does not query the network, so it is safe to call while
+              * the network is running the next frame on another thread.
+              *
+              * @param inference_ms The inference time of the frame in milliseconds.
+              * @param human The image containing detected humans.
+              * @param captured The capture time of the frame in steady clock
+              *                 seconds, which timestamps the recorded frame. A
+              *                 negative value stamps it at display time.
+              */
+            void DisplayResults(double inference_ms, cv::Mat &human,
+                                double captured = -1.0);
+
             /**
               * @brief Creates bounding boxes around detected objects in the input image.
               *
@@ -72,11 +94,11 @@ namespace TrackAI {
                                     std::vector<float> confidences);
 
             /**
-              * @brief Saves the processed images to a video file.
+              * @brief Finishes recording the processed images to video files.
               *
-              * This method takes a collection of images and saves them as a video file 
-              * in the specified format. It handles errors related to file access issues 
-              * and ensures the output video is correctly formatted.
+              * The images are encoded while the pipeline runs; this method waits for
+              * the remaining backlog, finalizes the last segment and reports the
+              * recording statistics.
               */
             void SaveResults();
     };
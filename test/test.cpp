@@ -10,7 +10,19 @@
  */
 
 #include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include "../include/detector_cascade.hpp"
+#include "../include/detector_service.hpp"
+#include "../include/latency_monitor.hpp"
 #include "../include/robot.hpp"
+#include "../include/roi_refiner.hpp"
+#include "../include/shm_ring.hpp"
+#include "../include/track_store.hpp"
 #include "opencv2/core/mat.hpp"
 #include "opencv2/imgcodecs.hpp"
 
@@ -82,6 +94,30 @@ TEST(HumanTrackerTest, Initialize_Update) {
   EXPECT_EQ(bboxes.size(), 2);
 }
 
+/**
+ * @brief Test case to validate that fresh detections replace the tracked boxes.
+ *
+ * Two frames with the same number of detections must leave the targets on
+ * the boxes of the second frame, and a frame without detections keeps one
+ * box per target.
+ */
+TEST(HumanTrackerTest, FollowsLatestDetections) {
+  TrackAI::Tracker kcf_tracker(TrackAI::TrackerBackend::KCF);
+  cv::Mat frame = img.clone();
+  kcf_tracker.Track(frame, {cv::Rect(50, 50, 60, 120),
+                            cv::Rect(200, 80, 60, 120)});
+
+  std::vector<cv::Rect> moved = {cv::Rect(300, 60, 60, 120),
+                                 cv::Rect(120, 200, 60, 120)};
+  frame = img.clone();
+  kcf_tracker.Track(frame, moved);
+  EXPECT_EQ(kcf_tracker.Targets(), moved);
+
+  frame = img.clone();
+  kcf_tracker.Track(frame, {});
+  EXPECT_EQ(kcf_tracker.Targets().size(), moved.size());
+}
+
 /**
  * @brief Test case to validate the bounding box creation in the Visualizer.
  *
@@ -100,3 +136,870 @@ TEST(VisualizationTest, CreateBoundingBoxTest) {
   ASSERT_EQ(bboxes.size(), 1);
   ASSERT_EQ(bboxes[0], cv::Rect(10, 20, 30, 40));
 }
+
+/**
+ * @brief Test case to validate that every tracker backend can be created.
+ *
+ * This test checks that each backend yields a tracker instance and a name.
+ */
+TEST(HumanTrackerTest, CreateEveryBackend) {
+  const TrackAI::TrackerBackend backends[] = {
+      TrackAI::TrackerBackend::CSRT, TrackAI::TrackerBackend::MIL,
+      TrackAI::TrackerBackend::KCF, TrackAI::TrackerBackend::MOSSE};
+  for (TrackAI::TrackerBackend backend : backends) {
+    EXPECT_FALSE(TrackAI::Tracker::Create(backend).empty());
+    EXPECT_FALSE(TrackAI::Tracker::BackendName(backend).empty());
+  }
+}
+
+/**
+ * @brief Test case to validate the per-target parallel update of the Tracker.
+ *
+ * This test checks that one box is kept per target across an update.
+ */
+TEST(HumanTrackerTest, PerTargetUpdate) {
+  TrackAI::Tracker kcf_tracker(TrackAI::TrackerBackend::KCF);
+  std::vector<cv::Rect> targets = {cv::Rect(50, 50, 60, 120),
+                                   cv::Rect(200, 80, 60, 120),
+                                   cv::Rect(350, 60, 60, 120)};
+  kcf_tracker.Init(img, targets);
+  std::vector<cv::Rect> updated = kcf_tracker.Update(img);
+  ASSERT_EQ(updated.size(), targets.size());
+  EXPECT_EQ(kcf_tracker.Found().size(), targets.size());
+  EXPECT_GE(kcf_tracker.LastTrackMs(), 0.0);
+}
+
+/**
+ * @brief Test case to validate the automatic degradation of the Tracker.
+ *
+ * With an unreachable budget the tracker must step down to a cheaper backend,
+ * skipping MIL, which is not cheaper than CSRT.
+ */
+TEST(HumanTrackerTest, DegradesWhenOverBudget) {
+  TrackAI::Tracker csrt_tracker(TrackAI::TrackerBackend::CSRT, 1e-6);
+  csrt_tracker.Init(img, {cv::Rect(50, 50, 60, 120)});
+  for (int i = 0; i < TrackAI::Tracker::kDegradeAfterFrames; ++i) {
+    csrt_tracker.Update(img);
+  }
+  EXPECT_EQ(csrt_tracker.Backend(), TrackAI::TrackerBackend::KCF);
+  EXPECT_EQ(TrackAI::Tracker::Cheaper(TrackAI::TrackerBackend::MIL),
+            TrackAI::TrackerBackend::KCF);
+  EXPECT_EQ(TrackAI::Tracker::Cheaper(TrackAI::TrackerBackend::MOSSE),
+            TrackAI::TrackerBackend::FLOW);
+}
+
+/**
+ * @brief Test case to validate the degradation of a Tracker fed detections on every frame.
+ *
+ * In the robot pipeline nearly every frame has detections, so the time of
+ * following them must count against the budget too: with an unreachable
+ * budget the tracker must step down while its targets stay on the detections.
+ */
+TEST(HumanTrackerTest, DegradesWhileFollowingDetections) {
+  TrackAI::Tracker csrt_tracker(TrackAI::TrackerBackend::CSRT, 1e-6);
+  std::vector<cv::Rect> people = {cv::Rect(50, 50, 60, 120),
+                                  cv::Rect(200, 80, 60, 120)};
+  for (int i = 0; i < TrackAI::Tracker::kDegradeAfterFrames; ++i) {
+    cv::Mat frame = img.clone();
+    csrt_tracker.Track(frame, people);
+    EXPECT_EQ(csrt_tracker.Targets(), people);
+  }
+  EXPECT_EQ(csrt_tracker.Backend(), TrackAI::TrackerBackend::KCF);
+}
+
+/**
+ * @brief Test case to validate the optical-flow box propagation.
+ *
+ * The image is shifted by a known offset, and the propagated box must follow
+ * the shift with a non-zero quality score.
+ */
+TEST(FlowPropagatorTest, FollowsTranslation) {
+  cv::Mat shifted;
+  cv::Mat shift = (cv::Mat_<double>(2, 3) << 1, 0, 6, 0, 1, 4);
+  cv::warpAffine(img, shifted, shift, img.size());
+
+  TrackAI::FlowPropagator propagator;
+  cv::Rect box(img.cols / 4, img.rows / 4, img.cols / 3, img.rows / 3);
+  propagator.Init(img, {box});
+  std::vector<cv::Rect> moved = propagator.Propagate(shifted);
+
+  ASSERT_EQ(moved.size(), 1);
+  EXPECT_NEAR(moved[0].x, box.x + 6, 2);
+  EXPECT_NEAR(moved[0].y, box.y + 4, 2);
+  EXPECT_GT(propagator.Quality()[0], 0.0f);
+}
+
+/**
+ * @brief Test case to validate the asynchronous inference API.
+ *
+ * This test checks that a submitted frame yields the same output shape as the
+ * synchronous path, that the end of its forward pass is stamped by the
+ * inference thread rather than at collection, and that the counters account
+ * for it.
+ */
+TEST(AsyncDetectorTest, SubmitAndWait) {
+  TrackAI::Detector async_detector;
+  cv::dnn::Net net = async_detector.Load(model_path);
+  std::vector<cv::Mat> expected = async_detector.PreProcess(img, net);
+
+  auto submitted = std::chrono::steady_clock::now();
+  uint64 first = async_detector.Submit(img);
+  uint64 second = async_detector.Submit(img);
+  std::chrono::steady_clock::time_point completed;
+  std::vector<cv::Mat> outputs = async_detector.Wait(first, &completed);
+  ASSERT_EQ(outputs.size(), expected.size());
+  EXPECT_EQ(outputs[0].total(), expected[0].total());
+  EXPECT_GT(completed, submitted);
+
+  // Collected late, the second frame still reports when it finished
+  while (async_detector.Stats().completed < 2) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto collected = std::chrono::steady_clock::now();
+  ASSERT_TRUE(async_detector.Poll(second, &outputs, &completed));
+  EXPECT_LE(completed + std::chrono::milliseconds(50), collected);
+  TrackAI::AsyncStats stats = async_detector.Stats();
+  EXPECT_EQ(stats.completed, 2u);
+  EXPECT_EQ(stats.in_flight, 0);
+  EXPECT_LE(stats.max_in_flight, 2);
+}
+
+/**
+ * @brief Test case to validate that a rejected frame does not leak its inference slot.
+ *
+ * More empty frames than there are slots are submitted; every one must throw
+ * instead of blocking, and the counters must not count them.
+ */
+TEST(AsyncDetectorTest, EmptyFrameFreesSlot) {
+  TrackAI::Detector async_detector;
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_THROW(async_detector.Submit(cv::Mat()), cv::Exception);
+  }
+  EXPECT_EQ(async_detector.Stats().submitted, 0u);
+  EXPECT_EQ(async_detector.Stats().in_flight, 0);
+}
+
+/**
+ * @brief Test case to validate buffer recycling in the FramePool.
+ *
+ * Buffers must be handed out until the pool is exhausted, then dropped, and
+ * reused with the same memory once released.
+ */
+TEST(FramePoolTest, RecyclesReleasedBuffers) {
+  TrackAI::FramePool pool(2, cv::Size(64, 48), CV_8UC3);
+  cv::Mat first, second, third;
+  ASSERT_TRUE(pool.Acquire(&first));
+  ASSERT_TRUE(pool.Acquire(&second));
+  EXPECT_FALSE(pool.Acquire(&third));
+  EXPECT_EQ(pool.Stats().dropped, 1u);
+  EXPECT_EQ(pool.Stats().in_use, 2u);
+
+  uchar *memory = first.data;
+  first.release();
+  ASSERT_TRUE(pool.Acquire(&third));
+  EXPECT_EQ(third.data, memory);
+  EXPECT_TRUE(pool.Owns(third));
+  EXPECT_EQ(pool.Stats().peak_in_use, 2u);
+}
+
+/**
+ * @brief Test case to validate the frame age accounting of the FrameGrabber.
+ *
+ * A missing camera must be reported, and the capture-to-result age must be
+ * measured from the capture timestamp of the frame.
+ */
+TEST(FrameGrabberTest, ReportsResultAge) {
+  TrackAI::FrameGrabber grabber;
+  EXPECT_FALSE(grabber.Open(99));
+
+  TrackAI::StampedFrame frame;
+  frame.sequence = 0;
+  frame.captured = std::chrono::steady_clock::now() -
+                   std::chrono::milliseconds(50);
+  EXPECT_GE(grabber.ReportResult(frame), 50.0);
+
+  TrackAI::GrabberStats stats = grabber.Stats();
+  EXPECT_EQ(stats.results, 1u);
+  EXPECT_EQ(stats.reallocated, 0u);
+  EXPECT_GE(stats.max_age_ms, 50.0);
+}
+
+/**
+ * @brief Test case to validate segmented recording in the Recorder.
+ *
+ * Ten frames stamped at 10 FPS with 0.5 s segments must produce two finalized
+ * AVI segments of five frames each, with the measured frame rate.
+ */
+TEST(RecorderTest, WritesSegmentsWithMeasuredRate) {
+  TrackAI::Recorder test_recorder("recorder_test", 0.5, 2);
+  cv::Mat frame(48, 64, CV_8UC3, cv::Scalar(0, 128, 255));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(test_recorder.Push(frame, 100.0 + 0.1 * i));
+  }
+  test_recorder.Close();
+
+  TrackAI::RecorderStats stats = test_recorder.Stats();
+  EXPECT_EQ(stats.written, 10u);
+  EXPECT_EQ(stats.backlog, 0u);
+  EXPECT_NEAR(stats.segment_fps, 10.0, 1e-6);
+
+  std::vector<std::string> segments = test_recorder.Segments();
+  EXPECT_EQ(segments.size(), 2u);
+  if (!segments.empty()) {
+    std::ifstream segment(segments[0], std::ios::binary);
+    std::vector<char> header(64);
+    segment.read(header.data(), header.size());
+    EXPECT_EQ(std::string(header.data(), 4), "RIFF");
+    uint32_t total_frames;
+    std::memcpy(&total_frames, header.data() + 48, sizeof(total_frames));
+    EXPECT_EQ(total_frames, 5u);
+  }
+
+  // Leave no segments behind in the working directory
+  for (const std::string &path : segments) {
+    std::remove(path.c_str());
+  }
+}
+
+/**
+ * @brief Test case to validate the binary results log round trip.
+ *
+ * Records appended with a skipped frame must be found through the frame index,
+ * and reopening the log must continue after the last frame.
+ */
+TEST(ResultsLogTest, AppendAndSeek) {
+  std::remove("results_test.tlog");
+  std::remove(TrackAI::ResultsLog::IndexPath("results_test.tlog").c_str());
+
+  TrackAI::DetectionRecord record = {};
+  record.confidence = 0.9f;
+  record.track_id = -1;
+  TrackAI::ResultsLog log;
+  ASSERT_TRUE(log.Open("results_test.tlog"));
+  record.frame_index = 0;
+  EXPECT_TRUE(log.Append(0, {record, record}));
+  record.frame_index = 2;
+  record.x = 42.0f;
+  EXPECT_TRUE(log.Append(2, {record}));
+  EXPECT_FALSE(log.Append(1, {record}));
+  log.Close();
+
+  ASSERT_TRUE(log.Open("results_test.tlog"));
+  EXPECT_EQ(log.NextFrame(), 3u);
+  log.Close();
+
+  TrackAI::ResultsLogReader reader;
+  ASSERT_TRUE(reader.Open("results_test.tlog"));
+  EXPECT_EQ(reader.Records(), 3u);
+  EXPECT_EQ(reader.Frames(), 3u);
+
+  uint32_t count = 0;
+  EXPECT_EQ(reader.Frame(1, &count), nullptr);
+  EXPECT_EQ(count, 0u);
+  const TrackAI::DetectionRecord *frame = reader.Frame(2, &count);
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(count, 1u);
+  EXPECT_EQ(frame->x, 42.0f);
+}
+
+/**
+ * @brief Test case to validate a results log whose index got ahead of its records.
+ *
+ * The two files are flushed independently, so the last record may be lost
+ * while its index entry survives. Readers must not index the frame, and
+ * reopening the log must drop it.
+ */
+TEST(ResultsLogTest, SkipsFramesPastTheRecords) {
+  const std::string path = "results_cut_test.tlog";
+  TrackAI::DetectionRecord record = {};
+  TrackAI::ResultsLog log;
+  ASSERT_TRUE(log.Open(path));
+  EXPECT_TRUE(log.Append(0, {record, record}));
+  EXPECT_TRUE(log.Append(1, {record}));
+  log.Close();
+  ASSERT_EQ(truncate(path.c_str(), TrackAI::ResultsLog::kHeaderSize +
+                     2 * sizeof(TrackAI::DetectionRecord)), 0);
+
+  TrackAI::ResultsLogReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  EXPECT_EQ(reader.Frames(), 1u);
+  uint32_t count = 0;
+  EXPECT_NE(reader.Frame(0, &count), nullptr);
+  EXPECT_EQ(count, 2u);
+  EXPECT_EQ(reader.Frame(1, &count), nullptr);
+  EXPECT_EQ(count, 0u);
+
+  ASSERT_TRUE(log.Open(path));
+  EXPECT_EQ(log.NextFrame(), 1u);
+  log.Close();
+  std::remove(path.c_str());
+  std::remove(TrackAI::ResultsLog::IndexPath(path).c_str());
+}
+
+/**
+ * @brief Test case to validate that a missing model is reported, not thrown.
+ *
+ * The benchmarks rely on this to fall back to synthetic network outputs.
+ */
+TEST(HumanTrackerTest, LoadModelReportsMissingFile) {
+  TrackAI::Robot headless_robot;
+  headless_robot.SetHeadless(true);
+  EXPECT_FALSE(headless_robot.LoadModel("missing_model.onnx"));
+}
+
+/**
+ * @brief Test case to validate the decoder selected from a YOLOv8 output shape.
+ *
+ * A person and a car candidate are placed in an 84 x 100 output. The
+ * person-only decoder must report the person alone, the all-class decoder both.
+ */
+TEST(OutputDecoderTest, DecodesChannelMajorOutput) {
+  const int anchors = 100;
+  const int sizes[] = {1, 84, anchors};
+  cv::Mat output(3, sizes, CV_32F, cv::Scalar(0));
+  float *data = output.ptr<float>();
+  const float person[] = {100, 200, 20, 40};
+  const float car[] = {300, 300, 10, 10};
+  for (int k = 0; k < 4; ++k) {
+    data[k * anchors + 3] = person[k];
+    data[k * anchors + 5] = car[k];
+  }
+  data[4 * anchors + 3] = 0.8f;        // person score
+  data[(4 + 2) * anchors + 5] = 0.9f;  // car score
+
+  TrackAI::OutputFormat format;
+  ASSERT_TRUE(TrackAI::DescribeOutput(output, &format));
+  EXPECT_EQ(format.layout, TrackAI::OutputLayout::YOLOV8);
+  EXPECT_EQ(format.anchors, anchors);
+  EXPECT_EQ(format.classes, 80);
+
+  TrackAI::DecoderParams params = {anchors, 80, 1.0f, 0.5f, 0.45f};
+  std::vector<int> ids;
+  std::vector<float> scores;
+  std::vector<cv::Rect> candidates;
+  TrackAI::SelectDecoder(format, true)(data, params, &ids, &scores, &candidates);
+  ASSERT_EQ(ids.size(), 1u);
+  EXPECT_EQ(candidates[0], cv::Rect(90, 90, 20, 20));
+
+  ids.clear();
+  scores.clear();
+  candidates.clear();
+  TrackAI::SelectDecoder(format, false)(data, params, &ids, &scores, &candidates);
+  ASSERT_EQ(ids.size(), 2u);
+  EXPECT_EQ(ids[1], 2);
+}
+
+/**
+ * @brief Test case to validate the person-only head pruning.
+ *
+ * The pruned network must output only the box and person rows, and find
+ * exactly the same people as the full network on every sample image.
+ */
+TEST(modeltest, PrunedHeadKeepsPersonDetections) {
+  TrackAI::Detector full;
+  TrackAI::Detector pruned;
+  cv::dnn::Net full_net = full.Load(model_path);
+  cv::dnn::Net pruned_net = pruned.Load(model_path, true, true);
+  EXPECT_EQ(pruned.Format().classes, 1);
+
+  for (int i = 0; i < 10; ++i) {
+    cv::Mat frame = cv::imread("../../Data/Images/img" + std::to_string(i) + ".jpg");
+    ASSERT_FALSE(frame.empty());
+
+    std::vector<cv::Mat> full_out = full.PreProcess(frame, full_net);
+    std::vector<cv::Mat> pruned_out = pruned.PreProcess(frame, pruned_net);
+    EXPECT_EQ(pruned_out[0].size[1], 5);
+
+    std::vector<int> full_ids, pruned_ids, full_keep, pruned_keep;
+    std::vector<float> full_conf, pruned_conf;
+    std::vector<cv::Rect> full_boxes, pruned_boxes;
+    full.PostProcess(frame, full_out, &full_ids, &full_conf, &full_boxes,
+                     &full_keep);
+    pruned.PostProcess(frame, pruned_out, &pruned_ids, &pruned_conf,
+                       &pruned_boxes, &pruned_keep);
+
+    ASSERT_EQ(pruned_keep.size(), full_keep.size());
+    for (size_t k = 0; k < full_keep.size(); ++k) {
+      EXPECT_EQ(pruned_boxes[pruned_keep[k]], full_boxes[full_keep[k]]);
+      EXPECT_FLOAT_EQ(pruned_conf[pruned_keep[k]], full_conf[full_keep[k]]);
+    }
+  }
+}
+
+/**
+ * @brief Test case to validate concurrent detection through the replica pool.
+ *
+ * Four threads share a pool of two replicas; each must find the same boxes
+ * with the same scores as a single detector, and every call must be
+ * accounted for.
+ */
+TEST(DetectorServiceTest, ConcurrentCallsMatchSingleDetector) {
+  std::vector<int> ids, expected_keep;
+  std::vector<float> scores;
+  std::vector<cv::Rect> expected_boxes;
+  TrackAI::Detector single;
+  cv::dnn::Net net = single.Load(model_path);
+  std::vector<cv::Mat> outputs = single.PreProcess(img, net);
+  single.PostProcess(img, outputs, &ids, &scores, &expected_boxes,
+                     &expected_keep);
+
+  TrackAI::DetectorService service;
+  service.Load(model_path, 2);
+  std::vector<std::vector<cv::Rect>> found_boxes(4);
+  std::vector<std::vector<float>> found_scores(4);
+  std::vector<std::thread> callers;
+  for (int t = 0; t < 4; ++t) {
+    callers.emplace_back([&service, &found_boxes, &found_scores, t] {
+      std::vector<int> call_ids, keep;
+      std::vector<float> call_scores;
+      std::vector<cv::Rect> call_boxes;
+      service.Detect(img, &call_ids, &call_scores, &call_boxes, &keep);
+      for (int k : keep) {
+        found_boxes[t].push_back(call_boxes[k]);
+        found_scores[t].push_back(call_scores[k]);
+      }
+    });
+  }
+  for (std::thread &caller : callers) {
+    caller.join();
+  }
+
+  for (int t = 0; t < 4; ++t) {
+    ASSERT_EQ(found_boxes[t].size(), expected_keep.size());
+    for (size_t k = 0; k < expected_keep.size(); ++k) {
+      EXPECT_EQ(found_boxes[t][k], expected_boxes[expected_keep[k]]);
+      EXPECT_FLOAT_EQ(found_scores[t][k], scores[expected_keep[k]]);
+    }
+  }
+  TrackAI::ServiceStats stats = service.Stats();
+  EXPECT_EQ(stats.replicas, 2u);
+  EXPECT_EQ(stats.calls, 4u);
+  EXPECT_LE(stats.peak_busy, 2u);
+}
+
+/**
+ * @brief Test case to validate the constant-velocity target predictor.
+ *
+ * Two people walk in different directions and are measured in alternating
+ * order; each must keep its track, and the prediction half a second after
+ * the last frame must match their straight-line motion.
+ */
+TEST(TargetPredictorTest, PredictsConstantVelocity) {
+  TrackAI::TargetPredictor predictor;
+  std::vector<int> ids;
+  for (int k = 0; k < 30; ++k) {
+    double t = 0.1 * k;
+    std::vector<Eigen::Vector3d> measured = {
+        Eigen::Vector3d(1.0 + 0.5 * t, 0.0, 3.0),
+        Eigen::Vector3d(-2.0, 1.0 - 0.3 * t, 4.0)};
+    if (k % 2) std::swap(measured[0], measured[1]);
+    predictor.Update(t, measured, &ids);
+    EXPECT_EQ(ids[k % 2], 0);
+    EXPECT_EQ(ids[1 - k % 2], 1);
+  }
+
+  std::vector<TrackAI::PredictedTarget> targets;
+  predictor.PredictAll(3.4, &targets);
+  ASSERT_EQ(targets.size(), 2u);
+  EXPECT_NEAR(targets[0].position.x(), 2.7, 0.01);
+  EXPECT_NEAR(targets[1].position.y(), -0.02, 0.01);
+  EXPECT_NEAR(targets[0].velocity.x(), 0.5, 0.01);
+
+  // Tracks without measurements are dropped after max_misses updates.
+  for (int k = 0; k < 6; ++k) {
+    predictor.Update(3.0 + 0.1 * k, {}, &ids);
+  }
+  EXPECT_EQ(predictor.Size(), 0u);
+}
+
+/**
+ * @brief Test case to validate the robot frame positions of detected boxes.
+ *
+ * With the default calibration, a 300 pixel tall person is 3.4 m from the
+ * camera, and the camera sits 2 m along the robot's Z axis. A box centered
+ * on the principal point lies on the optical axis, and a box shifted by
+ * half the focal length lies half its depth to the side.
+ */
+TEST(RobotTest, BackProjectsBoxesIntoMetres) {
+  std::vector<cv::Point3d> positions;
+  robot.CoorInRobotFrame({cv::Rect(245, 90, 150, 300),
+                          cv::Rect(545, 90, 150, 300)}, &positions);
+  ASSERT_EQ(positions.size(), 2u);
+  EXPECT_NEAR(positions[0].x, 0.0, 1e-6);
+  EXPECT_NEAR(positions[0].y, 0.0, 1e-6);
+  EXPECT_NEAR(positions[0].z, 5.4, 1e-6);
+  EXPECT_NEAR(positions[1].x, 1.7, 1e-6);
+  EXPECT_NEAR(positions[1].z, 5.4, 1e-6);
+}
+
+/**
+ * @brief Test case to validate the shared-memory ring with a separate consumer process.
+ *
+ * A forked consumer follows the ring while the publisher writes frames as
+ * fast as it can. Every frame the consumer accepts must be intact, in
+ * order, and the frames it misses must be reported as dropped.
+ */
+TEST(ShmRingTest, ConsumerProcessReadsIntactFrames) {
+  const std::string name = "/trackai-test-" + std::to_string(getpid());
+  const uint64_t frames = 2000;
+  TrackAI::ShmPublisher publisher;
+  ASSERT_TRUE(publisher.Open(name, 4, 64 * 48 * 3, 8));
+
+  int ready[2];
+  ASSERT_EQ(pipe(ready), 0);
+  pid_t consumer = fork();
+  ASSERT_GE(consumer, 0);
+  if (consumer == 0) {
+    // Stand-in consumer: exit code 0 if every accepted frame is intact.
+    TrackAI::ShmSubscriber subscriber;
+    int status = subscriber.Open(name) ? 0 : 2;
+    char byte = 1;
+    if (write(ready[1], &byte, 1) != 1) _exit(3);
+    uint64_t last = 0;
+    uint64_t accepted = 0;
+    TrackAI::ShmFrame frame;
+    for (int idle = 0; status == 0 && last < frames && idle < 5000;) {
+      if (!subscriber.Next(&frame)) {
+        usleep(1000);
+        idle++;
+        continue;
+      }
+      idle = 0;
+      bool intact = frame.frame_index == frame.sequence &&
+                    frame.count == frame.sequence % 8 &&
+                    frame.image.rows == 48 && frame.image.cols == 64;
+      for (int r = 0; intact && r < frame.image.rows; ++r) {
+        const uchar *row = frame.image.ptr(r);
+        for (int c = 0; c < frame.image.cols * 3; ++c) {
+          intact = intact && row[c] == static_cast<uchar>(frame.sequence);
+        }
+      }
+      for (uint32_t i = 0; intact && i < frame.count; ++i) {
+        intact = frame.records[i].track_id == static_cast<int>(frame.sequence);
+      }
+      if (!subscriber.Valid(frame)) continue;  // Overwritten while read
+      if (!intact || frame.sequence <= last) status = 4;
+      last = frame.sequence;
+      accepted++;
+    }
+    if (last != frames || accepted + subscriber.Dropped() > frames) status = 5;
+    _exit(status);
+  }
+
+  char byte = 0;
+  ASSERT_EQ(read(ready[0], &byte, 1), 1);
+  std::vector<TrackAI::DetectionRecord> records;
+  for (uint64_t sequence = 1; sequence <= frames; ++sequence) {
+    cv::Mat image(48, 64, CV_8UC3, cv::Scalar::all(sequence % 256));
+    TrackAI::DetectionRecord record = {};
+    record.track_id = static_cast<int>(sequence);
+    records.assign(sequence % 8, record);
+    ASSERT_TRUE(publisher.Publish(sequence, 0, image, records));
+  }
+
+  int status = -1;
+  ASSERT_EQ(waitpid(consumer, &status, 0), consumer);
+  close(ready[0]);
+  close(ready[1]);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+/**
+ * @brief Test case to validate that a slow reader never holds the publisher back.
+ *
+ * The publisher keeps overwriting the oldest slots; the reader skips the
+ * lost frames, counts them, and detects a view overwritten while held.
+ */
+TEST(ShmRingTest, SlowReaderSkipsOverwrittenFrames) {
+  const std::string name = "/trackai-test-slow-" + std::to_string(getpid());
+  TrackAI::ShmPublisher publisher;
+  ASSERT_TRUE(publisher.Open(name, 4, 16 * 16, 4));
+  TrackAI::ShmSubscriber subscriber;
+  ASSERT_TRUE(subscriber.Open(name));
+
+  cv::Mat image(16, 16, CV_8UC1, cv::Scalar(7));
+  std::vector<TrackAI::DetectionRecord> records;
+  for (uint64_t i = 1; i <= 10; ++i) {
+    ASSERT_TRUE(publisher.Publish(i, 0, image, records));
+  }
+
+  TrackAI::ShmFrame frame;
+  ASSERT_TRUE(subscriber.Next(&frame));
+  EXPECT_EQ(frame.sequence, 7u);
+  EXPECT_EQ(subscriber.Dropped(), 6u);
+  EXPECT_EQ(frame.image.at<uchar>(3, 3), 7);
+  EXPECT_TRUE(subscriber.Valid(frame));
+
+  for (uint64_t i = 11; i <= 14; ++i) {
+    ASSERT_TRUE(publisher.Publish(i, 0, image, records));
+  }
+  EXPECT_FALSE(subscriber.Valid(frame));
+  ASSERT_TRUE(subscriber.Latest(&frame));
+  EXPECT_EQ(frame.sequence, 14u);
+  EXPECT_FALSE(subscriber.Next(&frame));
+
+  // Frames larger than a slot are rejected rather than truncated.
+  EXPECT_FALSE(publisher.Publish(15, 0, cv::Mat(32, 32, CV_8UC1), records));
+  EXPECT_EQ(publisher.Rejected(), 1u);
+}
+
+/**
+ * @brief Test case to validate the crops planned around tracked boxes.
+ *
+ * Crops are padded squares clipped to the frame, and two people standing
+ * side by side share one crop.
+ */
+TEST(RoiRefinerTest, PlansPaddedMergedRegions) {
+  std::vector<cv::Rect> regions;
+  std::vector<cv::Rect> tracks = {cv::Rect(100, 100, 40, 100),
+                                  cv::Rect(120, 110, 40, 100),
+                                  cv::Rect(600, 400, 30, 60)};
+  TrackAI::RoiRefiner::PlanRegions(tracks, cv::Size(640, 480), 0.5f, &regions);
+  ASSERT_EQ(regions.size(), 2u);
+  EXPECT_EQ(regions[0], cv::Rect(20, 50, 220, 210));
+  EXPECT_EQ(regions[1], cv::Rect(555, 370, 85, 110));
+  for (const cv::Rect &track : tracks) {
+    bool covered = false;
+    for (const cv::Rect &region : regions) {
+      covered = covered || (region & track) == track;
+    }
+    EXPECT_TRUE(covered);
+  }
+}
+
+/**
+ * @brief Test case to validate that refinement finds the tracked people again.
+ *
+ * The first frame runs the full-frame pass; the same frame refined around
+ * its detections must find every person near the same box, unless the
+ * model rejects the crop batch and the refiner falls back.
+ */
+TEST(modeltest, RefinementFindsTrackedPeople) {
+  TrackAI::Detector detector;
+  cv::dnn::Net net = detector.Load(model_path, true, true);
+  TrackAI::RoiRefiner refiner;
+  cv::Mat frame = img.clone();
+
+  std::vector<int> ids, keep;
+  std::vector<float> scores;
+  std::vector<cv::Rect> boxes;
+  EXPECT_FALSE(refiner.Detect(detector, net, frame, {}, &ids, &scores,
+                              &boxes, &keep));
+  std::vector<cv::Rect> tracks;
+  for (int k : keep) tracks.push_back(boxes[k]);
+  ASSERT_FALSE(tracks.empty());
+
+  bool refined = refiner.Detect(detector, net, frame, tracks, &ids, &scores,
+                                &boxes, &keep);
+  TrackAI::RefinerStats stats = refiner.Stats();
+  EXPECT_EQ(stats.frames, 2u);
+  EXPECT_EQ(stats.refined + stats.fallbacks, 1u);
+  if (refined) {
+    EXPECT_GT(stats.compute_saved, 0.0);
+  }
+  for (const cv::Rect &track : tracks) {
+    double best = 0.0;
+    for (int k : keep) {
+      best = std::max(best, (boxes[k] & track).area() /
+                            static_cast<double>((boxes[k] | track).area()));
+    }
+    EXPECT_GT(best, 0.5);
+  }
+}
+
+/**
+ * @brief Test case to validate the latency-driven mode control of the cascade.
+ *
+ * Sustained frames over the budget step the cascade down one mode at a
+ * time, a single slow frame does not, and a long run of fast frames steps
+ * it back up.
+ */
+TEST(DetectorCascadeTest, SwitchesModesWithLatency) {
+  TrackAI::DetectorCascade cascade(100.0);
+  EXPECT_EQ(cascade.Mode(), TrackAI::CascadeMode::DNN);
+
+  cascade.ReportLatency(40.0);
+  cascade.ReportLatency(300.0);
+  EXPECT_EQ(cascade.Mode(), TrackAI::CascadeMode::DNN);
+
+  for (int i = 0; i < TrackAI::DetectorCascade::kDegradeAfterFrames; ++i) {
+    cascade.ReportLatency(300.0);
+  }
+  EXPECT_EQ(cascade.Mode(), TrackAI::CascadeMode::VERIFY);
+  for (int i = 0; i < TrackAI::DetectorCascade::kDegradeAfterFrames; ++i) {
+    cascade.ReportLatency(300.0);
+  }
+  EXPECT_EQ(cascade.Mode(), TrackAI::CascadeMode::HOG);
+
+  for (int i = 0; i < 100 && cascade.Mode() == TrackAI::CascadeMode::HOG; ++i) {
+    cascade.ReportLatency(10.0);
+  }
+  EXPECT_EQ(cascade.Mode(), TrackAI::CascadeMode::VERIFY);
+  EXPECT_EQ(cascade.Stats().switches, 3u);
+
+  // HOG alone needs no model and reports people only.
+  std::vector<int> hog_ids, hog_keep;
+  std::vector<float> hog_scores;
+  std::vector<cv::Rect> hog_boxes;
+  cascade.DetectHog(img, &hog_ids, &hog_scores, &hog_boxes, &hog_keep);
+  for (int k : hog_keep) {
+    EXPECT_EQ(hog_ids[k], 0);
+    EXPECT_EQ(hog_boxes[k] & cv::Rect(0, 0, img.cols, img.rows), hog_boxes[k]);
+  }
+}
+
+/**
+ * @brief Test case to validate the boxes the track store predicts for the next frame.
+ *
+ * A person walking at 300 px/s is predicted a tenth of a second ahead
+ * without moving its track, and a person missed in the last frame is left
+ * out of the prediction.
+ */
+TEST(TrackStoreTest, PredictsCurrentBoxesAhead) {
+  TrackAI::TrackStore store;
+  std::vector<int> ids;
+  for (int f = 0; f <= 30; ++f) {
+    std::vector<cv::Rect> seen = {cv::Rect(10 + 10 * f, 10, 40, 80)};
+    if (f < 30) seen.push_back(cv::Rect(600, 300, 40, 80));
+    store.Update(f / 30.0, seen, nullptr, &ids);
+  }
+  ASSERT_EQ(store.Size(), 2u);
+
+  std::vector<cv::Rect> predicted;
+  store.PredictedBoxes(1.1, &predicted);
+  ASSERT_EQ(predicted.size(), 1u);
+  EXPECT_EQ(predicted[0], cv::Rect(340, 10, 40, 80));
+
+  cv::Rect box;
+  ASSERT_TRUE(store.Box(ids[0], &box));
+  EXPECT_EQ(box, cv::Rect(310, 10, 40, 80));
+}
+
+/**
+ * @brief Test case to validate the identifiers and association of the track store.
+ *
+ * Moving people keep their identifiers across frames, including through a
+ * missed frame, a removed track hands its identifier to the next new one,
+ * and the remaining tracks are still found after the swap-remove.
+ */
+TEST(TrackStoreTest, KeepsStableIdsThroughMotionAndRemoval) {
+  TrackAI::TrackStore store(0.1f, 0.3f, 2);
+  std::vector<cv::Rect> people = {cv::Rect(10, 10, 40, 80),
+                                  cv::Rect(200, 10, 40, 80),
+                                  cv::Rect(400, 300, 40, 80)};
+  std::vector<int> ids, first, removed;
+  store.Update(0.0, people, nullptr, &first);
+  ASSERT_EQ(first.size(), 3u);
+  EXPECT_NE(first[0], first[1]);
+  EXPECT_NE(first[1], first[2]);
+
+  // Walk right at 300 px/s, detected in reverse order, missing once.
+  for (int f = 1; f <= 10; ++f) {
+    std::vector<cv::Rect> seen;
+    for (int p = 2; p >= 0; --p) {
+      if (f == 5 && p == 1) continue;
+      seen.push_back(people[p] + cv::Point(10 * f, 0));
+    }
+    store.Update(f / 30.0, seen, nullptr, &ids, &removed);
+    EXPECT_TRUE(removed.empty());
+    EXPECT_EQ(ids.front(), first[2]);
+    EXPECT_EQ(ids.back(), first[0]);
+  }
+  EXPECT_EQ(store.Size(), 3u);
+  EXPECT_EQ(store.Age(first[0]), 10);
+
+  cv::Rect box;
+  ASSERT_TRUE(store.Box(first[0], &box));
+  EXPECT_EQ(box, people[0] + cv::Point(100, 0));
+
+  // The first person leaves; the last one moves into its slot.
+  EXPECT_TRUE(store.Remove(first[0]));
+  EXPECT_FALSE(store.Remove(first[0]));
+  EXPECT_FALSE(store.Box(first[0], &box));
+  ASSERT_TRUE(store.Box(first[2], &box));
+  EXPECT_EQ(box, people[2] + cv::Point(100, 0));
+  int newcomer = store.Insert(cv::Rect(900, 500, 40, 80), nullptr);
+  EXPECT_EQ(newcomer, first[0]);
+
+  // Everyone missing for too long is pruned and reported.
+  std::vector<cv::Rect> nobody;
+  for (int f = 0; f < 3; ++f) {
+    store.Update(1.0 + f / 30.0, nobody, nullptr, &ids, &removed);
+  }
+  EXPECT_EQ(removed.size(), 3u);
+  EXPECT_EQ(store.Size(), 0u);
+}
+
+/**
+ * @brief Test case to validate that the appearance breaks ties between overlapping people.
+ *
+ * Two people standing at the same place, one red and one blue, are told
+ * apart by their signatures alone.
+ */
+TEST(TrackStoreTest, AppearanceSeparatesOverlappingPeople) {
+  cv::Mat frame(200, 200, CV_8UC3, cv::Scalar(0, 0, 255));
+  frame(cv::Rect(100, 0, 100, 200)).setTo(cv::Scalar(255, 0, 0));
+  const int n = TrackAI::TrackStore::kSignatureSize;
+  std::vector<float> signatures(2 * n);
+  TrackAI::TrackStore::ComputeSignature(frame, cv::Rect(0, 0, 100, 200),
+                                        &signatures[0]);
+  TrackAI::TrackStore::ComputeSignature(frame, cv::Rect(100, 0, 100, 200),
+                                        &signatures[n]);
+  float total = 0.0f;
+  for (int k = 0; k < n; ++k) total += signatures[k];
+  EXPECT_NEAR(total, 1.0f, 1e-4f);
+
+  TrackAI::TrackStore store;
+  std::vector<cv::Rect> boxes = {cv::Rect(50, 50, 40, 80),
+                                 cv::Rect(52, 50, 40, 80)};
+  std::vector<int> first, ids;
+  store.Update(0.0, boxes, signatures.data(), &first);
+
+  // Swap the boxes: the signatures outweigh the small change in overlap.
+  std::vector<cv::Rect> swapped = {boxes[1], boxes[0]};
+  store.Update(0.1, swapped, signatures.data(), &ids);
+  EXPECT_EQ(ids, first);
+}
+
+/**
+ * @brief Test case to validate the latency attribution of the frames.
+ *
+ * Stage durations are recovered from the stamps, the percentiles cover only
+ * the rolling window, and the record fields round to the latency unit and
+ * saturate instead of wrapping.
+ */
+TEST(LatencyMonitorTest, SummarizesRollingWindowAndEncodesRecords) {
+  typedef std::chrono::milliseconds ms;
+  const std::chrono::steady_clock::time_point t0 =
+      std::chrono::steady_clock::now();
+  TrackAI::LatencyMonitor monitor(10);
+  EXPECT_EQ(monitor.Summary().window, 0u);
+
+  // Twenty frames aged 1 to 20 ms; the window keeps the last ten.
+  for (int f = 1; f <= 20; ++f) {
+    TrackAI::FrameStamps stamps = TrackAI::LatencyMonitor::Begin(f, t0);
+    stamps.emitted = t0 + ms(f);
+    EXPECT_NEAR(monitor.Add(stamps), f, 1e-9);
+  }
+  TrackAI::LatencySummary summary = monitor.Summary();
+  EXPECT_EQ(summary.frames, 20u);
+  EXPECT_EQ(summary.window, 10u);
+  EXPECT_NEAR(summary.p50_ms, 16.0, 1e-9);
+  EXPECT_NEAR(summary.max_ms, 20.0, 1e-9);
+  EXPECT_NEAR(summary.track_ms, 15.5, 1e-9);
+  EXPECT_NEAR(summary.wait_ms, 0.0, 1e-9);
+
+  TrackAI::FrameStamps stamps = TrackAI::LatencyMonitor::Begin(21, t0);
+  stamps.started = t0 + ms(3);
+  stamps.inferred = t0 + ms(48);
+  stamps.decoded = t0 + ms(50) + std::chrono::microseconds(260);
+  stamps.emitted = t0 + ms(10000);
+  TrackAI::DetectionRecord record = {};
+  TrackAI::LatencyMonitor::Encode(stamps, &record);
+  EXPECT_EQ(record.wait_latency, 30);
+  EXPECT_EQ(record.inference_latency, 450);
+  EXPECT_EQ(record.decode_latency, 23);
+  EXPECT_EQ(record.track_latency, 65535);
+}